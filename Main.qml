@@ -70,6 +70,10 @@ ApplicationWindow {
 
             console.log("API Response Received:", ip, hostname, city, region, country, loc, postal, timezone);
         }
+
+        onHostProfileReceived: function(host, addresses) {
+            console.log("Host profile received:", host, addresses.length, "addresses");
+        }
     }
 
     // NetworkManager component for handling network-related functionality
@@ -415,7 +419,15 @@ ApplicationWindow {
                             Item { width: 10; }
                         }
                     }
-                    Item{}
+
+                    // Look up every A and AAAA record of a host instead of the first IPv4 address
+                    CheckBox {
+                        Layout.alignment: Qt.AlignHCenter | Qt.AlignVCenter
+                        text: qsTr("All host addresses")
+                        font.pixelSize: 12
+                        checked: ipValidator.resolveAllAddresses
+                        onToggled: ipValidator.resolveAllAddresses = checked
+                    }
                     // detecting the IP call
                     Button {
                         id: shortButton
@@ -691,10 +703,101 @@ ApplicationWindow {
                     }
                 }
 
+                RowLayout {
+                    Layout.alignment: Qt.AlignHCenter
+                    spacing: 10
+
+                    Button {
+                        text: "Statistics"
+                        onClicked: {
+                            statisticsDialog.refresh();
+                            statisticsDialog.open();
+                        }
+                    }
+
+                    Button {
+                        text: "Close"
+                        onClicked: savedAddressesDialog.close();
+                    }
+                }
+            }
+        }
+        // aggregate statistics over the stored entries
+        Dialog {
+            id: statisticsDialog
+            width: parent.width * 0.8
+            height: parent.height * 0.7
+            modal: true
+            title: "Statistics"
+
+            function refresh() {
+                statisticsModel.clear();
+                let groups = ipValidator.statistics(dimensionBox.currentValue);
+                for (let group of groups) {
+                    statisticsModel.append({ value: group.value || "Unknown", count: group.count });
+                }
+
+                let lookups = 0;
+                for (let bucket of ipValidator.lookupVolume(24)) {
+                    lookups += bucket.lookups;
+                }
+                statisticsSummary.text = "Stored addresses: " + ipValidator.storedAddressCount()
+                        + "    Lookups in the last 24h: " + lookups;
+            }
+
+            ColumnLayout {
+                anchors.fill: parent
+                spacing: 10
+
+                Text {
+                    id: statisticsSummary
+                    font.pixelSize: 14
+                }
+
+                ComboBox {
+                    id: dimensionBox
+                    Layout.fillWidth: true
+                    textRole: "text"
+                    valueRole: "value"
+                    model: [
+                        { text: "By country", value: "country" },
+                        { text: "By region", value: "region" },
+                        { text: "By timezone", value: "timezone" }
+                    ]
+                    onActivated: statisticsDialog.refresh()
+                }
+
+                ListView {
+                    model: statisticsModel
+                    clip: true
+                    Layout.fillWidth: true
+                    Layout.fillHeight: true
+
+                    delegate: Rectangle {
+                        width: parent.width
+                        height: 32
+                        color: index % 2 === 0 ? "#f2f2f2" : "#ffffff"
+                        RowLayout {
+                            anchors.fill: parent
+                            anchors.margins: 6
+                            Text {
+                                text: model.value
+                                font.pixelSize: 14
+                                Layout.fillWidth: true
+                            }
+                            Text {
+                                text: model.count
+                                font.pixelSize: 14
+                                color: "#007aff"
+                            }
+                        }
+                    }
+                }
+
                 Button {
                     text: "Close"
                     Layout.alignment: Qt.AlignHCenter
-                    onClicked: savedAddressesDialog.close();
+                    onClicked: statisticsDialog.close();
                 }
             }
         }
@@ -712,6 +815,10 @@ ApplicationWindow {
         ListModel {
             id: savedAddressesModel
         }
+
+        ListModel {
+            id: statisticsModel
+        }
     }
 
     // connection indication icon
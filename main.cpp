@@ -3,17 +3,117 @@
 #include <QQmlContext>
 #include <QStandardPaths>
 #include <QDebug>
+#include <QCommandLineParser>
+#include <QQuickWindow>
+#include <QTimer>
 
 #include "validator.h"
 #include "databaseManager.h"
 #include "networkManager.h"
+#include "datasetImporter.h"
+#include "deltaSync.h"
+#include "cacheWarmer.h"
+#include "columnarExporter.h"
+#include "traceBuffer.h"
+#include "startupTimeline.h"
 
 int main(int argc, char *argv[]) {
+    StartupTimeline::mark("process.start");
     QGuiApplication app(argc, argv);
+    StartupTimeline::mark("application.created");
 
-    // Initialize DatabaseManager
-    if (!DatabaseManager::instance().initializeDatabase()) {
-        qWarning() << "Failed to initialize the database!";
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption importOption("import", "Import a CSV or JSONL geolocation dataset into the offline store and exit.", "file");
+    QCommandLineOption measureStartupOption("measure-startup", "Print the startup timeline once the first frame is shown and exit.");
+    QCommandLineOption storageDirOption("storage-dir", "Directory for the database files.", "directory");
+    QCommandLineOption shardsOption("shards", "Split stored addresses across this many database files. Only applies to new storage.", "count", "1");
+    QCommandLineOption exportDeltaOption("export-delta", "Export addresses added since --since to a delta file and exit.", "file");
+    QCommandLineOption sinceOption("since", "Change sequence number printed by the previous --export-delta.", "sequence", "0");
+    QCommandLineOption importDeltaOption("import-delta", "Merge a delta file exported by another instance and exit.", "file");
+    QCommandLineOption warmupOption("warmup", "Number of most looked-up addresses to preload into memory after startup.", "count", "256");
+    QCommandLineOption prefetchBudgetOption("prefetch-budget", "Maximum API requests after startup for hot addresses missing from the database.", "count", "0");
+    QCommandLineOption exportColumnarOption("export-columnar", "Export the address store to a compressed columnar file and exit.", "file");
+    QCommandLineOption compactOption("compact", "Compact the database files one at a time and exit.");
+    parser.addOption(importOption);
+    parser.addOption(measureStartupOption);
+    parser.addOption(storageDirOption);
+    parser.addOption(shardsOption);
+    parser.addOption(exportDeltaOption);
+    parser.addOption(sinceOption);
+    parser.addOption(importDeltaOption);
+    parser.addOption(warmupOption);
+    parser.addOption(prefetchBudgetOption);
+    parser.addOption(exportColumnarOption);
+    parser.addOption(compactOption);
+    parser.process(app);
+
+    if (parser.isSet(storageDirOption) || parser.isSet(shardsOption)) {
+        const QString directory = parser.isSet(storageDirOption) ? parser.value(storageDirOption)
+                                                                 : QCoreApplication::applicationDirPath();
+        if (!DatabaseManager::instance().setStorageLocation(directory, parser.value(shardsOption).toInt())) {
+            qWarning() << "Invalid storage location:" << directory;
+            return 1;
+        }
+    }
+
+    // Headless maintenance mode
+    if (parser.isSet(compactOption)) {
+        return DatabaseManager::instance().compactStorage() ? 0 : 1;
+    }
+
+    // Headless analytics export
+    if (parser.isSet(exportColumnarOption)) {
+        ColumnarExporter exporter;
+        QObject::connect(&exporter, &ColumnarExporter::debugMessage, [](const QString &message) {
+            qInfo().noquote() << message;
+        });
+        return exporter.exportFile(parser.value(exportColumnarOption)).ok ? 0 : 1;
+    }
+
+    // Headless cache sync mode
+    if (parser.isSet(exportDeltaOption) || parser.isSet(importDeltaOption)) {
+        if (!DatabaseManager::instance().initializeDatabase()) {
+            qWarning() << "Failed to initialize the database!";
+            return 1;
+        }
+
+        DeltaSync sync;
+        QObject::connect(&sync, &DeltaSync::debugMessage, [](const QString &message) {
+            qInfo().noquote() << message;
+        });
+
+        if (parser.isSet(importDeltaOption) && sync.importChanges(parser.value(importDeltaOption)) < 0) {
+            return 1;
+        }
+        if (parser.isSet(exportDeltaOption)
+            && sync.exportChanges(parser.value(exportDeltaOption), parser.value(sinceOption).toLongLong()) < 0) {
+            return 1;
+        }
+        return 0;
+    }
+
+    // Headless import mode
+    if (parser.isSet(importOption)) {
+        if (!DatabaseManager::instance().initializeDatabase()) {
+            qWarning() << "Failed to initialize the database!";
+            return 1;
+        }
+
+        DatasetImporter importer;
+        QObject::connect(&importer, &DatasetImporter::debugMessage, [](const QString &message) {
+            qInfo().noquote() << message;
+        });
+        QObject::connect(&importer, &DatasetImporter::progress, [](qint64 done, qint64 total, double rowsPerSecond) {
+            qInfo().noquote() << QString("%1% (%2 rows/s)").arg(100.0 * done / qMax<qint64>(total, 1), 0, 'f', 1)
+                                                           .arg(rowsPerSecond, 0, 'f', 0);
+        });
+
+        const DatasetImporter::Summary summary = importer.importFile(parser.value(importOption));
+        if (lcTrace().isDebugEnabled()) {
+            TraceBuffer::instance().dump();
+        }
+        return summary.ok ? 0 : 1;
     }
 
     // Register Validator and NetworkManager for QML
@@ -21,6 +121,38 @@ int main(int argc, char *argv[]) {
     qmlRegisterType<NetworkManager>("networkmanager", 1, 0, "NetworkManager");
 
     QQmlApplicationEngine engine;
+    const bool measureStartup = parser.isSet(measureStartupOption);
+    const int warmupCount = parser.value(warmupOption).toInt();
+    const int prefetchBudget = parser.value(prefetchBudgetOption).toInt();
+
+    // The window is interactive once its first frame is on screen. Storage is opened right
+    // after that, during idle time, unless a lookup needs it earlier.
+    QObject::connect(&engine, &QQmlApplicationEngine::objectCreated, &app,
+                     [measureStartup, warmupCount, prefetchBudget](QObject *object) {
+        auto *window = qobject_cast<QQuickWindow *>(object);
+        if (!window) {
+            return;
+        }
+
+        QObject::connect(window, &QQuickWindow::frameSwapped, qApp, [measureStartup, warmupCount, prefetchBudget]() {
+            StartupTimeline::mark("first.frame");
+            const double timeToInteractiveMs = StartupTimeline::elapsedMs();
+            QTimer::singleShot(0, qApp, [measureStartup, timeToInteractiveMs, warmupCount, prefetchBudget]() {
+                // Hot records are preloaded in small slices so input stays responsive
+                if (DatabaseManager::instance().initializeDatabase() && warmupCount > 0 && !measureStartup) {
+                    auto *warmer = new CacheWarmer(qApp);
+                    QObject::connect(warmer, &CacheWarmer::finished, warmer, &QObject::deleteLater);
+                    warmer->start(warmupCount, prefetchBudget);
+                }
+                StartupTimeline::dump();
+                if (measureStartup) {
+                    qInfo().noquote() << QString("Time to interactive: %1 ms")
+                                         .arg(timeToInteractiveMs, 0, 'f', 2);
+                    QCoreApplication::quit();
+                }
+            });
+        }, Qt::SingleShotConnection);
+    });
 
     // Handle object creation failure in QML
     QObject::connect(
@@ -32,6 +164,13 @@ int main(int argc, char *argv[]) {
 
     // Load the QML module
     engine.loadFromModule("GeoCatch", "Main");
+    StartupTimeline::mark("qml.loaded");
 
-    return app.exec();
+    const int exitCode = app.exec();
+
+    // Hot-path trace, collected when QT_LOGGING_RULES enables geocatch.trace.debug
+    if (lcTrace().isDebugEnabled()) {
+        TraceBuffer::instance().dump();
+    }
+    return exitCode;
 }
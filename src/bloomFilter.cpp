@@ -0,0 +1,110 @@
+#include "bloomFilter.h"
+#include "keyHash.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+
+namespace {
+constexpr quint32 fileMagic = 0x47434246; // "GCBF"
+constexpr quint32 fileVersion = 2; // 2: block index taken from the high hash bits
+}
+
+BloomFilter::BloomFilter(qsizetype expectedItems, int bitsPerItem) : bitsPerItem(qMax(bitsPerItem, 1)) {
+    reset(expectedItems);
+}
+
+void BloomFilter::reset(qsizetype expectedItems) {
+    expected = qMax<qsizetype>(expectedItems, 64);
+    const qsizetype blockBits = wordsPerBlock * 64;
+    blockCount = qMax<qsizetype>((expected * bitsPerItem + blockBits - 1) / blockBits, 1);
+    words.fill(0, blockCount * wordsPerBlock);
+    count = 0;
+}
+
+qsizetype BloomFilter::blockIndex(quint64 hash) const {
+    // High 32 bits pick the block, low 32 bits the positions inside it, so the two are independent
+    return qsizetype((quint64(quint32(hash >> 32)) * quint64(blockCount)) >> 32);
+}
+
+void BloomFilter::insert(QStringView key) {
+    const quint64 hash = stableKeyHash(key);
+    quint64 *block = words.data() + blockIndex(hash) * wordsPerBlock;
+    const quint32 h1 = quint32(hash);
+    const quint32 h2 = ((h1 >> 16) | (h1 << 16)) | 1;
+
+    for (int i = 0; i < bitsPerKey; ++i) {
+        const quint32 bit = (h1 + quint32(i) * h2) & 511;
+        block[bit >> 6] |= quint64(1) << (bit & 63);
+    }
+    ++count;
+}
+
+bool BloomFilter::mayContain(QStringView key) const {
+    const quint64 hash = stableKeyHash(key);
+    const quint64 *block = words.constData() + blockIndex(hash) * wordsPerBlock;
+    const quint32 h1 = quint32(hash);
+    const quint32 h2 = ((h1 >> 16) | (h1 << 16)) | 1;
+
+    for (int i = 0; i < bitsPerKey; ++i) {
+        const quint32 bit = (h1 + quint32(i) * h2) & 511;
+        if (!(block[bit >> 6] & (quint64(1) << (bit & 63)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BloomFilter::save(const QString &path, quint64 tag) const {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_5);
+    out << fileMagic << fileVersion << tag
+        << qint64(expected) << qint64(count) << qint32(bitsPerItem) << qint64(blockCount);
+    for (quint64 word : words) {
+        out << word;
+    }
+
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+bool BloomFilter::load(const QString &path, quint64 tag) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_5);
+
+    quint32 magic = 0, version = 0;
+    quint64 storedTag = 0;
+    qint64 storedExpected = 0, storedCount = 0, storedBlocks = 0;
+    qint32 storedBitsPerItem = 0;
+    in >> magic >> version >> storedTag >> storedExpected >> storedCount >> storedBitsPerItem >> storedBlocks;
+
+    if (in.status() != QDataStream::Ok || magic != fileMagic || version != fileVersion
+        || storedTag != tag || storedBlocks <= 0
+        || file.size() - file.pos() != storedBlocks * wordsPerBlock * qint64(sizeof(quint64))) {
+        return false;
+    }
+
+    QList<quint64> storedWords(storedBlocks * wordsPerBlock);
+    for (quint64 &word : storedWords) {
+        in >> word;
+    }
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    words = std::move(storedWords);
+    blockCount = storedBlocks;
+    expected = storedExpected;
+    count = storedCount;
+    bitsPerItem = storedBitsPerItem;
+    return true;
+}
@@ -0,0 +1,69 @@
+#include "cacheWarmer.h"
+
+#include <QTimer>
+
+#include "databaseManager.h"
+#include "networkManager.h"
+#include "logging.h"
+
+namespace {
+constexpr int preloadSlice = 32; ///< Addresses read per event loop iteration.
+}
+
+CacheWarmer::CacheWarmer(QObject *parent) : QObject(parent), networkManager(new NetworkManager(this)) {}
+
+void CacheWarmer::start(int hotCount, int budget) {
+    apiBudget = budget;
+    pending = DatabaseManager::instance().getHotAddresses(hotCount);
+    GEOCATCH_DEBUG_MESSAGE(lcDatabase, "Warming up " + QString::number(pending.size()) + " hot addresses.");
+    QTimer::singleShot(0, this, &CacheWarmer::preloadNext);
+}
+
+void CacheWarmer::preloadNext() {
+    DatabaseManager &database = DatabaseManager::instance();
+    for (int i = 0; i < preloadSlice && !pending.isEmpty(); ++i) {
+        const QString address = pending.takeFirst();
+        if (database.getSpecificAddressData(address).isEmpty()) {
+            missing.append(address);
+        } else {
+            ++preloaded;
+        }
+    }
+
+    if (!pending.isEmpty()) {
+        QTimer::singleShot(0, this, &CacheWarmer::preloadNext);
+        return;
+    }
+    prefetchMissing();
+}
+
+void CacheWarmer::prefetchMissing() {
+    const QStringList batch = missing.mid(0, apiBudget);
+    if (batch.isEmpty() || !networkManager->isOnline()) {
+        emit finished(preloaded, 0);
+        return;
+    }
+
+    QList<QFuture<bool>> fetches;
+    for (const QString &address : batch) {
+        fetches.append(networkManager->fetchAddressDataCoalesced(address).then(this, [address](const QVariantMap &data) {
+            if (data.isEmpty()) {
+                return false;
+            }
+            DatabaseManager &database = DatabaseManager::instance();
+            database.saveUniqueAddress(address, data);
+            return !database.getSpecificAddressData(address).isEmpty();
+        }));
+    }
+
+    QtFuture::whenAll(fetches.begin(), fetches.end()).then(this, [this](const QList<QFuture<bool>> &results) {
+        int prefetched = 0;
+        for (const QFuture<bool> &result : results) {
+            if (!result.isCanceled() && result.resultCount() > 0 && result.result()) {
+                ++prefetched;
+            }
+        }
+        GEOCATCH_DEBUG_MESSAGE(lcDatabase, "Prefetched " + QString::number(prefetched) + " hot addresses.");
+        emit finished(preloaded, prefetched);
+    });
+}
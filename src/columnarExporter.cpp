@@ -0,0 +1,223 @@
+#include "columnarExporter.h"
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHostAddress>
+#include <QSaveFile>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtEndian>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "databaseManager.h"
+#include "stringDictionary.h"
+#include "ipScanner.h"
+
+namespace {
+
+constexpr char fileMagic[4] = {'G', 'C', 'C', 'F'};
+constexpr quint32 fileVersion = 1;
+
+enum ColumnType : quint8 { AddressColumn = 1, StringColumn = 2, DictionaryColumn = 3, Float64Column = 4, Int64Column = 5 };
+
+struct ColumnSpec {
+    const char *name;
+    ColumnType type;
+};
+
+constexpr std::array<ColumnSpec, 10> columns = {{
+    {"address", AddressColumn},
+    {"hostname", StringColumn},
+    {"city", DictionaryColumn},
+    {"region", DictionaryColumn},
+    {"country", DictionaryColumn},
+    {"postal", DictionaryColumn},
+    {"timezone", DictionaryColumn},
+    {"latitude", Float64Column},
+    {"longitude", Float64Column},
+    {"change_seq", Int64Column},
+}};
+
+template <typename T>
+void appendLittleEndian(QByteArray &out, T value) {
+    char bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, sizeof(T));
+}
+
+/**
+ * Arrow-style string column: offsets first, then the concatenated UTF-8 bytes.
+ */
+struct StringColumnBuilder {
+    QByteArray offsets;
+    QByteArray bytes;
+
+    StringColumnBuilder() { appendLittleEndian<quint32>(offsets, 0); }
+
+    void append(const QString &value) {
+        bytes += value.toUtf8();
+        appendLittleEndian<quint32>(offsets, quint32(bytes.size()));
+    }
+
+    QByteArray take() {
+        QByteArray data = offsets + bytes;
+        *this = StringColumnBuilder();
+        return data;
+    }
+};
+
+void appendAddress(QByteArray &out, const QString &address) {
+    // IPv4 is by far the common case and skips QHostAddress parsing
+    quint32 ipv4 = 0;
+    const QByteArray latin1 = address.toLatin1();
+    char key[16] = {};
+    if (IpScanner::parseIpv4(latin1.constData(), latin1.size(), &ipv4)) {
+        key[10] = char(0xff);
+        key[11] = char(0xff);
+        qToBigEndian(ipv4, key + 12);
+    } else {
+        const Q_IPV6ADDR ipv6 = QHostAddress(address).toIPv6Address();
+        std::copy(std::begin(ipv6.c), std::end(ipv6.c), key);
+    }
+    out.append(key, sizeof(key));
+}
+
+} // namespace
+
+ColumnarExporter::ColumnarExporter(QObject *parent) : QObject(parent) {}
+
+void ColumnarExporter::setRowGroupSize(int rows) {
+    rowGroupSize = qMax(rows, 1024);
+}
+
+ColumnarExporter::Summary ColumnarExporter::exportFile(const QString &path) {
+    Summary summary;
+    QElapsedTimer timer;
+    timer.start();
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        emit debugMessage("Failed to open export file: " + path);
+        return summary;
+    }
+
+    QByteArray header(fileMagic, sizeof(fileMagic));
+    appendLittleEndian<quint32>(header, fileVersion);
+    appendLittleEndian<quint32>(header, quint32(columns.size()));
+    for (const ColumnSpec &column : columns) {
+        const QByteArray name(column.name);
+        appendLittleEndian<quint8>(header, column.type);
+        appendLittleEndian<quint16>(header, quint16(name.size()));
+        header += name;
+    }
+    file.write(header);
+
+    DatabaseManager &database = DatabaseManager::instance();
+    const qint64 totalRows = database.getAddressCount();
+
+    std::array<QByteArray, columns.size()> buffers;
+    StringColumnBuilder hostnames;
+    QList<quint64> rowGroupOffsets;
+    quint32 rowsInGroup = 0;
+    bool writeOk = true;
+
+    // Columns of a row group are compressed in parallel, then written in column order
+    auto flushRowGroup = [&]() {
+        if (rowsInGroup == 0) {
+            return;
+        }
+        buffers[1] = hostnames.take();
+        const QList<QByteArray> raw(buffers.begin(), buffers.end());
+        const QList<QByteArray> compressed = QtConcurrent::blockingMapped<QList<QByteArray>>(
+            raw, [](const QByteArray &data) { return qCompress(data, 6); });
+
+        rowGroupOffsets.append(quint64(file.pos()));
+        QByteArray group;
+        appendLittleEndian<quint32>(group, rowsInGroup);
+        for (const QByteArray &column : compressed) {
+            appendLittleEndian<quint32>(group, quint32(column.size()));
+            group += column;
+        }
+        writeOk = writeOk && file.write(group) == group.size();
+
+        for (QByteArray &buffer : buffers) {
+            buffer.clear();
+        }
+        summary.rows += rowsInGroup;
+        rowsInGroup = 0;
+        emit progress(summary.rows, totalRows);
+    };
+
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    const bool readOk = database.forEachRecord([&](const AddressRecord &record) {
+        appendAddress(buffers[0], record.address);
+        hostnames.append(record.hostname);
+        appendLittleEndian<quint32>(buffers[2], record.city);
+        appendLittleEndian<quint32>(buffers[3], record.region);
+        appendLittleEndian<quint32>(buffers[4], record.country);
+        appendLittleEndian<quint32>(buffers[5], record.postal);
+        appendLittleEndian<quint32>(buffers[6], record.timezone);
+
+        // loc is stored as "lat,lon" text
+        const qsizetype comma = record.loc.indexOf(',');
+        bool latOk = false, lonOk = false;
+        const double latitude = comma > 0 ? QStringView(record.loc).left(comma).toDouble(&latOk) : 0;
+        const double longitude = comma > 0 ? QStringView(record.loc).mid(comma + 1).toDouble(&lonOk) : 0;
+        appendLittleEndian<double>(buffers[7], latOk && lonOk ? latitude : missing);
+        appendLittleEndian<double>(buffers[8], latOk && lonOk ? longitude : missing);
+        appendLittleEndian<qint64>(buffers[9], record.changeSeq);
+
+        if (++rowsInGroup == quint32(rowGroupSize)) {
+            flushRowGroup();
+        }
+        return writeOk;
+    });
+    flushRowGroup();
+
+    if (!readOk || !writeOk) {
+        emit debugMessage("Export failed after " + QString::number(summary.rows) + " rows.");
+        file.cancelWriting();
+        return summary;
+    }
+
+    // Dictionary section, shared by every dictionary column
+    const QList<QString> values = StringDictionary::instance().valuesFrom(0);
+    StringColumnBuilder dictionary;
+    for (const QString &value : values) {
+        dictionary.append(value);
+    }
+    const QByteArray dictionaryData = qCompress(dictionary.take(), 6);
+    const quint64 dictionaryOffset = quint64(file.pos());
+    QByteArray tail;
+    appendLittleEndian<quint32>(tail, quint32(values.size()));
+    appendLittleEndian<quint32>(tail, quint32(dictionaryData.size()));
+    tail += dictionaryData;
+
+    QByteArray footer;
+    appendLittleEndian<quint64>(footer, dictionaryOffset);
+    appendLittleEndian<quint64>(footer, quint64(summary.rows));
+    appendLittleEndian<quint32>(footer, quint32(rowGroupOffsets.size()));
+    for (quint64 offset : std::as_const(rowGroupOffsets)) {
+        appendLittleEndian<quint64>(footer, offset);
+    }
+    tail += footer;
+    appendLittleEndian<quint32>(tail, quint32(footer.size()));
+    tail.append(fileMagic, sizeof(fileMagic));
+
+    if (file.write(tail) != tail.size() || !file.commit()) {
+        emit debugMessage("Failed to write export file: " + path);
+        return summary;
+    }
+
+    summary.ok = true;
+    summary.bytes = QFileInfo(path).size();
+    summary.seconds = timer.nsecsElapsed() / 1e9;
+    emit debugMessage("Exported " + QString::number(summary.rows) + " rows ("
+                      + QString::number(summary.bytes / 1024.0 / 1024.0, 'f', 1) + " MiB) in "
+                      + QString::number(summary.seconds, 'f', 2) + " s ("
+                      + QString::number(summary.rowsPerSecond(), 'f', 0) + " rows/s).");
+    return summary;
+}
@@ -1,29 +1,56 @@
 #include "databaseManager.h"
+#include "stringDictionary.h"
+#include "logging.h"
+#include "traceBuffer.h"
+#include "startupTimeline.h"
+#include "keyHash.h"
 
 #include <QCoreApplication>
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QAtomicInteger>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <numeric>
 
 DatabaseManager::DatabaseManager(QObject *parent) : QObject(parent) {
-    QString connectionName = "GeoCatchDB";
+    // Opening the file and checking the schema is deferred to initializeDatabase()
+    storageDirectory = QCoreApplication::applicationDirPath();
+    databasePath = storageDirectory + "/api_responses.db";
+}
 
-    if (QSqlDatabase::contains(connectionName)) {
-        db = QSqlDatabase::database(connectionName);
-    } else {
-        db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
-        db.setDatabaseName(QCoreApplication::applicationDirPath() + "/api_responses.db");
+bool DatabaseManager::setStorageLocation(const QString &directory, int shards) {
+    if (initialized) {
+        qCWarning(lcDatabase) << "Storage location cannot change after the database is initialized.";
+        return false;
     }
 
-    if (!db.isOpen() && !db.open()) {
-        qWarning() << "Database failed to open:" << db.lastError().text();
-    } else {
-        qDebug() << "Database successfully opened.";
+    if (!QDir().mkpath(directory)) {
+        qCWarning(lcDatabase) << "Failed to create storage directory:" << directory;
+        return false;
     }
+
+    storageDirectory = QDir(directory).absolutePath();
+    databasePath = storageDirectory + "/api_responses.db";
+    requestedShardCount = qMax(shards, 0);
+    return true;
 }
 
 DatabaseManager::~DatabaseManager() {
+    for (const QString &shardConnection : std::as_const(shardConnectionNames)) {
+        QSqlDatabase::database(shardConnection, false).close();
+        QSqlDatabase::removeDatabase(shardConnection);
+    }
+
     QString connectionName = "GeoCatchDB";
     if (QSqlDatabase::contains(connectionName)) {
         QSqlDatabase db = QSqlDatabase::database(connectionName);
@@ -34,76 +61,722 @@ DatabaseManager::~DatabaseManager() {
 
         // Ensure no active queries are left
         QSqlDatabase::removeDatabase(connectionName);
-        qDebug() << "Database connection removed.";
+        qCDebug(lcDatabase) << "Database connection removed.";
+
+        // Persist the filter after the file is closed so the fingerprint matches the final state
+        saveAddressFilter();
     } else {
-        qDebug() << "No database connection to remove.";
+        qCDebug(lcDatabase) << "No database connection to remove.";
     }
 }
 
 
 bool DatabaseManager::initializeDatabase() {
+    if (initialized) {
+        return true;
+    }
+
+    // A failure is reported once; later calls fail fast instead of repeating the error
+    if (initializationFailed) {
+        return false;
+    }
+
+    initializationFailed = !openStorage();
+    return !initializationFailed;
+}
+
+bool DatabaseManager::openStorage() {
     QString connectionName = "GeoCatchDB";
+    StartupTimeline::mark("database.open.begin");
 
     if (!QSqlDatabase::contains(connectionName)) {
-        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
-        db.setDatabaseName(QCoreApplication::applicationDirPath() + "/api_responses.db");
-
-        if (!db.open()) {
-            qWarning() << "Failed to open database:" << db.lastError().text();
-            return false;
-        }
-        qDebug() << "Database successfully opened.";
+        db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(databasePath);
+    } else {
+        db = QSqlDatabase::database(connectionName, false);
     }
 
-    QSqlDatabase db = QSqlDatabase::database(connectionName);
-    if (!db.isOpen()) {
-        qWarning() << "Database is not open!";
+    if (!db.isOpen() && !db.open()) {
+        qCWarning(lcDatabase) << "Failed to open database:" << db.lastError().text();
+        emit databaseError("Failed to initialize the database. Please check your setup.");
         return false;
     }
+    qCDebug(lcDatabase) << "Database successfully opened.";
 
     QSqlQuery query(db);
-    QString createTable = R"(
-        CREATE TABLE IF NOT EXISTS api_responses (
+    QString createDictionary = R"(
+        CREATE TABLE IF NOT EXISTS string_dictionary (
+            id INTEGER PRIMARY KEY,
+            value TEXT NOT NULL UNIQUE
+        )
+    )";
+
+    if (!query.exec(createDictionary)) {
+        qCWarning(lcDatabase) << "Failed to create dictionary table:" << query.lastError().text();
+        emit databaseError("Failed to prepare the database schema. Please check your setup.");
+        return false;
+    }
+
+    if (!dictionaryLoaded && !loadDictionary()) {
+        emit databaseError("Failed to prepare the database schema. Please check your setup.");
+        return false;
+    }
+
+    if (!query.exec(R"(
+            CREATE TABLE IF NOT EXISTS lookup_volume (
+                hour INTEGER PRIMARY KEY,
+                lookups INTEGER NOT NULL
+            )
+        )")
+        || !query.exec(R"(
+            CREATE TABLE IF NOT EXISTS lookup_history (
+                address TEXT PRIMARY KEY,
+                lookups INTEGER NOT NULL,
+                last_lookup INTEGER NOT NULL
+            ) WITHOUT ROWID
+        )")
+        || !query.exec(R"(
+            CREATE TABLE IF NOT EXISTS storage_settings (
+                name TEXT PRIMARY KEY,
+                value INTEGER NOT NULL
+            )
+        )")) {
+        qCWarning(lcDatabase) << "Failed to create catalog tables:" << query.lastError().text();
+        emit databaseError("Failed to prepare the database schema. Please check your setup.");
+        return false;
+    }
+
+    if (!query.exec("SELECT value FROM storage_settings WHERE name = 'change_seq'")) {
+        qCWarning(lcDatabase) << "Failed to read storage settings:" << query.lastError().text();
+        emit databaseError("Failed to prepare the database schema. Please check your setup.");
+        return false;
+    }
+    lastChangeSeq = query.next() ? query.value(0).toLongLong() : 0;
+    query.finish();
+
+    const int shards = resolveShardCount();
+    if (shards < 1) {
+        emit databaseError("Failed to prepare the database schema. Please check your setup.");
+        return false;
+    }
+
+    // Unsharded storage keeps api_responses in the main file, sharded storage in the shard files
+    const bool addressTablesReady = shards == 1 ? prepareAddressTables(db, true) : openShards(shards);
+    if (!addressTablesReady) {
+        emit databaseError("Failed to prepare the database schema. Please check your setup.");
+        return false;
+    }
+
+    if (!addressFilterReady) {
+        loadAddressFilter();
+    }
+
+    initialized = true;
+    StartupTimeline::mark("database.ready");
+    return true;
+}
+
+QString DatabaseManager::responsesTableSql(const QString &tableName) {
+    // city, region, country, postal and timezone hold string_dictionary IDs, change_seq orders
+    // rows for delta export
+    return QString(R"(
+        CREATE TABLE IF NOT EXISTS %1 (
             id INTEGER PRIMARY KEY,
             address TEXT UNIQUE,
             hostname TEXT,
-            city TEXT,
-            region TEXT,
-            country TEXT,
+            city INTEGER,
+            region INTEGER,
+            country INTEGER,
             loc TEXT,
-            postal TEXT,
-            timezone TEXT
+            postal INTEGER,
+            timezone INTEGER,
+            change_seq INTEGER NOT NULL DEFAULT 0
         )
-    )";
+    )").arg(tableName);
+}
+
+bool DatabaseManager::prepareAddressTables(QSqlDatabase db, bool allowMigration) {
+    // Version 0 stored every field as TEXT, version 1 stores repeated fields as dictionary IDs,
+    // version 2 adds the aggregate statistics tables, version 3 adds change_seq
+    QSqlQuery query(db);
+    int schemaVersion = 0;
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        schemaVersion = query.value(0).toInt();
+    }
+    query.finish();
+
+    // The migration sets version 1 in its own transaction, so a later failure cannot make the
+    // next start convert the dictionary IDs a second time
+    if (schemaVersion < 1 && allowMigration && tableExists("api_responses") && !migrateToDictionarySchema()) {
+        qCWarning(lcDatabase) << "Failed to migrate api_responses to the dictionary schema.";
+        return false;
+    }
+
+    if (!query.exec(responsesTableSql("api_responses"))) {
+        qCWarning(lcDatabase) << "Failed to create table:" << query.lastError().text();
+        return false;
+    }
+    qCDebug(lcDatabase) << "Table created or already exists in" << db.databaseName();
+
+    // Each step records its version as soon as it succeeds
+    if (schemaVersion < 1 && !setSchemaVersion(db, 1)) {
+        return false;
+    }
+
+    if (!createStatisticsTables(db, schemaVersion < 2)) {
+        return false;
+    }
+    if (schemaVersion < 2 && !setSchemaVersion(db, 2)) {
+        return false;
+    }
+
+    if (schemaVersion < 3 && !addChangeSequenceColumn(db)) {
+        return false;
+    }
+
+    if (!query.exec("CREATE INDEX IF NOT EXISTS api_responses_change_seq ON api_responses (change_seq)")) {
+        qCWarning(lcDatabase) << "Failed to create change index:" << query.lastError().text();
+        return false;
+    }
+
+    if (schemaVersion < 3 && !setSchemaVersion(db, 3)) {
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::setSchemaVersion(QSqlDatabase db, int version) {
+    QSqlQuery query(db);
+    if (!query.exec(QString("PRAGMA user_version = %1").arg(version))) {
+        qCWarning(lcDatabase) << "Failed to record schema version" << version << ":" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::addChangeSequenceColumn(QSqlDatabase db) {
+    QSqlQuery query(db);
+    if (!query.exec("SELECT 1 FROM pragma_table_info('api_responses') WHERE name = 'change_seq'")) {
+        qCWarning(lcDatabase) << "Failed to inspect api_responses:" << query.lastError().text();
+        return false;
+    }
+    const bool hasColumn = query.next();
+    query.finish();
+
+    if (!hasColumn && !query.exec("ALTER TABLE api_responses ADD COLUMN change_seq INTEGER NOT NULL DEFAULT 0")) {
+        qCWarning(lcDatabase) << "Failed to add change_seq:" << query.lastError().text();
+        return false;
+    }
+
+    // Existing rows get sequence numbers in insertion order, so a first delta export includes them
+    if (!query.exec("SELECT COALESCE(MAX(id), 0) FROM api_responses WHERE change_seq = 0") || !query.next()) {
+        qCWarning(lcDatabase) << "Failed to count unsequenced rows:" << query.lastError().text();
+        return false;
+    }
+    const qint64 maxId = query.value(0).toLongLong();
+    query.finish();
+    if (maxId == 0) {
+        return true;
+    }
+
+    const qint64 first = reserveChangeSequence(maxId);
+    query.prepare("UPDATE api_responses SET change_seq = :first - 1 + id WHERE change_seq = 0");
+    query.bindValue(":first", first);
+    if (first < 0 || !query.exec()) {
+        qCWarning(lcDatabase) << "Failed to number existing rows:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+qint64 DatabaseManager::reserveChangeSequence(qint64 count) {
+    // The high-water mark lives in the catalog so numbers are never reused, even after a clear
+    QSqlQuery query(getDatabase());
+    query.prepare("INSERT OR REPLACE INTO storage_settings (name, value) VALUES ('change_seq', :last)");
+    query.bindValue(":last", lastChangeSeq + count);
+    if (!query.exec()) {
+        qCWarning(lcDatabase) << "Failed to reserve change sequence:" << query.lastError().text();
+        return -1;
+    }
+
+    const qint64 first = lastChangeSeq + 1;
+    lastChangeSeq += count;
+    return first;
+}
+
+int DatabaseManager::resolveShardCount() {
+    QSqlQuery query(db);
+    if (!query.exec("SELECT value FROM storage_settings WHERE name = 'shard_count'")) {
+        qCWarning(lcDatabase) << "Failed to read storage settings:" << query.lastError().text();
+        return 0;
+    }
+
+    // The layout is fixed when a storage directory is first used
+    if (query.next()) {
+        const int stored = query.value(0).toInt();
+        if (requestedShardCount > 0 && requestedShardCount != stored) {
+            qCWarning(lcDatabase) << "Storage was created with" << stored << "shards, ignoring requested"
+                                  << requestedShardCount;
+        }
+        return qMax(stored, 1);
+    }
+    query.finish();
+
+    int shards = qMax(requestedShardCount, 1);
+    if (shards > 1 && tableExists("api_responses")
+        && query.exec("SELECT EXISTS (SELECT 1 FROM api_responses)") && query.next() && query.value(0).toBool()) {
+        qCWarning(lcDatabase) << "Existing unsharded data found, keeping the single-file layout.";
+        shards = 1;
+    }
+    query.finish();
+
+    query.prepare("INSERT INTO storage_settings (name, value) VALUES ('shard_count', :shards)");
+    query.bindValue(":shards", shards);
+    if (!query.exec()) {
+        qCWarning(lcDatabase) << "Failed to store shard count:" << query.lastError().text();
+        return 0;
+    }
+    return shards;
+}
+
+QString DatabaseManager::shardFilePath(int shard) const {
+    return QString("%1/api_responses.shard-%2.db").arg(storageDirectory).arg(shard);
+}
+
+bool DatabaseManager::openShards(int shards) {
+    for (int shard = 0; shard < shards; ++shard) {
+        const QString connectionName = QString("GeoCatchDB-shard-%1").arg(shard);
+        QSqlDatabase shardDb = QSqlDatabase::contains(connectionName)
+                                   ? QSqlDatabase::database(connectionName, false)
+                                   : QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        shardDb.setDatabaseName(shardFilePath(shard));
+
+        if (!shardDb.isOpen() && !shardDb.open()) {
+            qCWarning(lcDatabase) << "Failed to open shard" << shard << ":" << shardDb.lastError().text();
+            return false;
+        }
+
+        if (!prepareAddressTables(shardDb, false)) {
+            return false;
+        }
+        shardConnectionNames.append(connectionName);
+    }
+
+    qCDebug(lcDatabase) << "Opened" << shards << "storage shards in" << storageDirectory;
+    return true;
+}
+
+int DatabaseManager::shardIndex(const QString &address) const {
+    return int(stableKeyHash(address) % quint64(shardConnectionNames.size()));
+}
+
+QSqlDatabase DatabaseManager::addressDatabase(const QString &address) const {
+    if (shardConnectionNames.isEmpty()) {
+        return getDatabase();
+    }
+    return QSqlDatabase::database(shardConnectionNames.at(shardIndex(address)));
+}
+
+QList<QSqlDatabase> DatabaseManager::addressDatabases() const {
+    if (shardConnectionNames.isEmpty()) {
+        return {getDatabase()};
+    }
+
+    QList<QSqlDatabase> databases;
+    for (const QString &connectionName : shardConnectionNames) {
+        databases.append(QSqlDatabase::database(connectionName));
+    }
+    return databases;
+}
+
+QStringList DatabaseManager::addressDatabaseFiles() const {
+    if (shardConnectionNames.isEmpty()) {
+        return {databasePath};
+    }
+
+    QStringList paths;
+    for (int shard = 0; shard < shardConnectionNames.size(); ++shard) {
+        paths.append(shardFilePath(shard));
+    }
+    return paths;
+}
+
+bool DatabaseManager::forEachShardInParallel(const std::function<bool(QSqlDatabase &, int)> &work) {
+    QList<int> shards(shardConnectionNames.size());
+    std::iota(shards.begin(), shards.end(), 0);
+
+    // QSqlDatabase connections are bound to a thread, so each task clones its own
+    auto runShard = [this, &work](int shard) {
+        const QString workerName = QString("%1-worker-%2").arg(shardConnectionNames.at(shard))
+                                       .arg(quintptr(QThread::currentThreadId()));
+        bool ok = false;
+        {
+            QSqlDatabase worker = QSqlDatabase::cloneDatabase(shardConnectionNames.at(shard), workerName);
+            if (worker.open()) {
+                ok = work(worker, shard);
+            } else {
+                qCWarning(lcDatabase) << "Failed to open shard" << shard << "worker:" << worker.lastError().text();
+            }
+            worker.close();
+        }
+        QSqlDatabase::removeDatabase(workerName);
+        return ok;
+    };
+
+    const QList<bool> results = QtConcurrent::blockingMapped<QList<bool>>(shards, runShard);
+    return !results.contains(false);
+}
+
+bool DatabaseManager::insertRecords(QSqlDatabase &db, const QString &table, const QList<AddressRecord> &records) {
+    QSqlQuery insert(db);
+    if (!insert.prepare(QString(R"(
+            INSERT INTO %1 (address, hostname, city, region, country, loc, postal, timezone)
+            VALUES (?, ?, ?, ?, ?, ?, ?, ?)
+        )").arg(table))) {
+        qCWarning(lcDatabase) << "Failed to prepare insert into" << table << ":" << insert.lastError().text();
+        return false;
+    }
+
+    for (const AddressRecord &record : records) {
+        insert.bindValue(0, record.address);
+        insert.bindValue(1, record.hostname);
+        insert.bindValue(2, record.city);
+        insert.bindValue(3, record.region);
+        insert.bindValue(4, record.country);
+        insert.bindValue(5, record.loc);
+        insert.bindValue(6, record.postal);
+        insert.bindValue(7, record.timezone);
+        if (!insert.exec()) {
+            qCWarning(lcDatabase) << "Failed to insert into" << table << ":" << insert.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DatabaseManager::createStatisticsTables(QSqlDatabase db, bool backfill) {
+    QSqlQuery query(db);
+
+    // Group counts are kept current by triggers, so every write path (single inserts,
+    // bulk imports, clears) maintains them without extra code
+    const QStringList statements = {
+        R"(CREATE TABLE IF NOT EXISTS response_stats (
+               dimension TEXT NOT NULL,
+               value_id INTEGER NOT NULL,
+               count INTEGER NOT NULL,
+               PRIMARY KEY (dimension, value_id)
+           ) WITHOUT ROWID)",
+        R"(CREATE TRIGGER IF NOT EXISTS response_stats_insert AFTER INSERT ON api_responses BEGIN
+               INSERT INTO response_stats VALUES ('country', NEW.country, 1)
+                   ON CONFLICT (dimension, value_id) DO UPDATE SET count = count + 1;
+               INSERT INTO response_stats VALUES ('region', NEW.region, 1)
+                   ON CONFLICT (dimension, value_id) DO UPDATE SET count = count + 1;
+               INSERT INTO response_stats VALUES ('timezone', NEW.timezone, 1)
+                   ON CONFLICT (dimension, value_id) DO UPDATE SET count = count + 1;
+           END)",
+        R"(CREATE TRIGGER IF NOT EXISTS response_stats_delete AFTER DELETE ON api_responses BEGIN
+               UPDATE response_stats SET count = count - 1 WHERE dimension = 'country' AND value_id = OLD.country;
+               UPDATE response_stats SET count = count - 1 WHERE dimension = 'region' AND value_id = OLD.region;
+               UPDATE response_stats SET count = count - 1 WHERE dimension = 'timezone' AND value_id = OLD.timezone;
+           END)",
+        R"(CREATE TRIGGER IF NOT EXISTS response_stats_update
+           AFTER UPDATE OF country, region, timezone ON api_responses BEGIN
+               UPDATE response_stats SET count = count - 1 WHERE dimension = 'country' AND value_id = OLD.country;
+               UPDATE response_stats SET count = count - 1 WHERE dimension = 'region' AND value_id = OLD.region;
+               UPDATE response_stats SET count = count - 1 WHERE dimension = 'timezone' AND value_id = OLD.timezone;
+               INSERT INTO response_stats VALUES ('country', NEW.country, 1)
+                   ON CONFLICT (dimension, value_id) DO UPDATE SET count = count + 1;
+               INSERT INTO response_stats VALUES ('region', NEW.region, 1)
+                   ON CONFLICT (dimension, value_id) DO UPDATE SET count = count + 1;
+               INSERT INTO response_stats VALUES ('timezone', NEW.timezone, 1)
+                   ON CONFLICT (dimension, value_id) DO UPDATE SET count = count + 1;
+           END)"
+    };
+
+    for (const QString &statement : statements) {
+        if (!query.exec(statement)) {
+            qCWarning(lcDatabase) << "Failed to create statistics schema:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    if (!backfill) {
+        return true;
+    }
+
+    // One-off full scan for databases created before the statistics existed
+    const bool ok = db.transaction()
+                    && query.exec("DELETE FROM response_stats")
+                    && query.exec(R"(
+                           INSERT INTO response_stats
+                           SELECT 'country', country, COUNT(*) FROM api_responses GROUP BY country
+                           UNION ALL
+                           SELECT 'region', region, COUNT(*) FROM api_responses GROUP BY region
+                           UNION ALL
+                           SELECT 'timezone', timezone, COUNT(*) FROM api_responses GROUP BY timezone
+                       )")
+                    && db.commit();
+
+    if (!ok) {
+        qCWarning(lcDatabase) << "Failed to backfill statistics:" << query.lastError().text();
+        db.rollback();
+    }
+    return ok;
+}
+
+bool DatabaseManager::loadDictionary() {
+    QSqlQuery query(getDatabase());
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT id, value FROM string_dictionary ORDER BY id")) {
+        qCWarning(lcDatabase) << "Failed to read string dictionary:" << query.lastError().text();
+        return false;
+    }
+
+    QList<QString> values;
+    while (query.next()) {
+        if (query.value(0).toLongLong() != values.size()) {
+            qCWarning(lcDatabase) << "String dictionary IDs are not contiguous, the database may be corrupted.";
+            return false;
+        }
+        values.append(query.value(1).toString());
+    }
+
+    // Every interning path opens storage first, so stored IDs never need remapping
+    if (!StringDictionary::instance().restore(values)) {
+        qCWarning(lcDatabase) << "String dictionary was used before the database was initialized.";
+        return false;
+    }
+
+    persistedDictionarySize = values.size();
+    dictionaryLoaded = true;
+    qCDebug(lcDatabase) << "Loaded" << values.size() << "dictionary entries.";
+    return true;
+}
+
+bool DatabaseManager::persistDictionary() {
+    if (StringDictionary::instance().size() <= persistedDictionarySize) {
+        return true;
+    }
+
+    QSqlDatabase db = getDatabase();
+    if (!db.transaction()) {
+        qCWarning(lcDatabase) << "Failed to start dictionary transaction:" << db.lastError().text();
+        return false;
+    }
+
+    // On failure persistedDictionarySize stays put and the in-memory entries keep their IDs,
+    // so the next call writes the same entries again
+    qsizetype writtenSize = 0;
+    if (!writeDictionary(writtenSize)) {
+        db.rollback();
+        return false;
+    }
+
+    if (!db.commit()) {
+        qCWarning(lcDatabase) << "Failed to commit dictionary entries:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    confirmDictionary(writtenSize);
+    return true;
+}
+
+bool DatabaseManager::writeDictionary(qsizetype &writtenSize) {
+    const QList<QString> pending = StringDictionary::instance().valuesFrom(quint32(persistedDictionarySize));
+    writtenSize = persistedDictionarySize;
+    if (pending.isEmpty()) {
+        return true;
+    }
+
+    QSqlQuery query(getDatabase());
+    if (!query.prepare("INSERT OR REPLACE INTO string_dictionary (id, value) VALUES (:id, :value)")) {
+        qCWarning(lcDatabase) << "Failed to prepare dictionary insert:" << query.lastError().text();
+        return false;
+    }
+
+    for (qsizetype i = 0; i < pending.size(); ++i) {
+        query.bindValue(":id", persistedDictionarySize + i);
+        query.bindValue(":value", pending.at(i));
+        if (!query.exec()) {
+            qCWarning(lcDatabase) << "Failed to store dictionary entry:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    writtenSize = persistedDictionarySize + pending.size();
+    return true;
+}
+
+void DatabaseManager::confirmDictionary(qsizetype writtenSize) {
+    persistedDictionarySize = qMax(persistedDictionarySize, writtenSize);
+}
+
+bool DatabaseManager::migrateToDictionarySchema() {
+    QSqlDatabase db = getDatabase();
+    if (!db.transaction()) {
+        qCWarning(lcDatabase) << "Failed to start migration transaction:" << db.lastError().text();
+        return false;
+    }
+
+    StringDictionary &dictionary = StringDictionary::instance();
+    QSqlQuery query(db);
+    QSqlQuery select(db);
+    QSqlQuery insert(db);
+    select.setForwardOnly(true);
+
+    bool ok = query.exec(responsesTableSql("api_responses_v1"))
+              && select.exec("SELECT address, hostname, city, region, country, loc, postal, timezone FROM api_responses")
+              && insert.prepare(R"(
+                  INSERT INTO api_responses_v1 (address, hostname, city, region, country, loc, postal, timezone)
+                  VALUES (:address, :hostname, :city, :region, :country, :loc, :postal, :timezone)
+              )");
+
+    qsizetype migratedRows = 0;
+    while (ok && select.next()) {
+        insert.bindValue(":address", select.value(0).toString());
+        insert.bindValue(":hostname", select.value(1).toString());
+        insert.bindValue(":city", dictionary.idFor(select.value(2).toString()));
+        insert.bindValue(":region", dictionary.idFor(select.value(3).toString()));
+        insert.bindValue(":country", dictionary.idFor(select.value(4).toString()));
+        insert.bindValue(":loc", select.value(5).toString());
+        insert.bindValue(":postal", dictionary.idFor(select.value(6).toString()));
+        insert.bindValue(":timezone", dictionary.idFor(select.value(7).toString()));
+        ok = insert.exec();
+        ++migratedRows;
+    }
+
+    // The old table cannot be dropped while statements still reference it
+    select.finish();
+    insert.finish();
+
+    qsizetype writtenDictionarySize = 0;
+    ok = ok && writeDictionary(writtenDictionarySize)
+         && query.exec("DROP TABLE api_responses")
+         && query.exec("ALTER TABLE api_responses_v1 RENAME TO api_responses")
+         && query.exec("PRAGMA user_version = 1");
+
+    if (!ok) {
+        qCWarning(lcDatabase) << "Migration failed:" << query.lastError().text() << insert.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    if (!db.commit()) {
+        qCWarning(lcDatabase) << "Failed to commit migration:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    confirmDictionary(writtenDictionarySize);
+
+    qCDebug(lcDatabase) << "Migrated" << migratedRows << "rows to the dictionary schema.";
+    return true;
+}
+
+quint64 DatabaseManager::databaseFingerprint() const {
+    quint64 fingerprint = 0;
+    for (const QString &path : addressDatabaseFiles()) {
+        QFileInfo info(path);
+        if (!info.exists()) {
+            return 0;
+        }
+        fingerprint = fingerprint * 31
+                      + ((quint64(info.size()) * 0x9E3779B97F4A7C15ull)
+                         ^ quint64(info.lastModified().toMSecsSinceEpoch()));
+    }
+    return fingerprint;
+}
+
+void DatabaseManager::loadAddressFilter() {
+    if (addressFilter.load(databasePath + ".bloom", databaseFingerprint())) {
+        addressFilterReady = true;
+        qCDebug(lcDatabase) << "Address filter loaded from sidecar with" << addressFilter.size() << "entries.";
+        return;
+    }
+
+    if (rebuildAddressFilter()) {
+        qCDebug(lcDatabase) << "Address filter rebuilt with" << addressFilter.size() << "entries.";
+    }
+}
+
+bool DatabaseManager::rebuildAddressFilter() {
+    addressFilterReady = false;
+
+    const QList<QSqlDatabase> databases = addressDatabases();
+    qint64 rows = 0;
+    for (const QSqlDatabase &addressDb : databases) {
+        if (!addressDb.isOpen()) {
+            qCWarning(lcDatabase) << "Database is not open, address filter disabled.";
+            return false;
+        }
+
+        QSqlQuery query(addressDb);
+        if (!query.exec("SELECT COUNT(*) FROM api_responses") || !query.next()) {
+            qCWarning(lcDatabase) << "Failed to count addresses for filter:" << query.lastError().text();
+            return false;
+        }
+        rows += query.value(0).toLongLong();
+    }
+
+    // Leave headroom so the filter does not saturate right after startup
+    addressFilter.reset(qMax<qsizetype>(rows * 2, 1024));
+
+    for (const QSqlDatabase &addressDb : databases) {
+        QSqlQuery query(addressDb);
+        query.setForwardOnly(true);
+        if (!query.exec("SELECT address FROM api_responses")) {
+            qCWarning(lcDatabase) << "Failed to read addresses for filter:" << query.lastError().text();
+            return false;
+        }
 
-    if (!query.exec(createTable)) {
-        qWarning() << "Failed to create table:" << query.lastError().text();
-    } else {
-        qDebug() << "Table created or already exists.";
+        while (query.next()) {
+            addressFilter.insert(query.value(0).toString());
+        }
     }
 
-    // Log existing tables in the database
-    qDebug() << "Tables in database:" << db.tables();
+    addressFilterReady = true;
     return true;
 }
 
+void DatabaseManager::saveAddressFilter() {
+    const QString sidecarPath = databasePath + ".bloom";
+    if (!addressFilterReady) {
+        QFile::remove(sidecarPath);
+        return;
+    }
+
+    if (!addressFilter.save(sidecarPath, databaseFingerprint())) {
+        qCWarning(lcDatabase) << "Failed to save address filter to" << sidecarPath;
+    }
+}
+
 bool DatabaseManager::addressExists(const QString &address) {
-    QSqlDatabase db = getDatabase();
+    if (!ensureInitialized()) {
+        return false;
+    }
+
+    // Definite miss, no need to touch SQLite
+    if (addressFilterReady && !addressFilter.mayContain(address)) {
+        GEOCATCH_TRACE("db.exists.filtered", address.size(), 0);
+        return false;
+    }
+
+    QSqlDatabase db = addressDatabase(address);
     if (!db.isOpen()) {
-        qWarning() << "Database is not open.";
+        qCWarning(lcDatabase) << "Database is not open.";
         return false;
     }
 
     QSqlQuery query(db);
     if (!query.prepare("SELECT COUNT(*) FROM api_responses WHERE address = :address")) {
-        qWarning() << "Failed to prepare query for checking address:" << query.lastError().text();
+        qCWarning(lcDatabase) << "Failed to prepare query for checking address:" << query.lastError().text();
         return false;
     }
 
     query.bindValue(":address", address);
 
     if (!query.exec()) {
-        qWarning() << "Failed to execute query for checking address:" << query.lastError().text();
+        qCWarning(lcDatabase) << "Failed to execute query for checking address:" << query.lastError().text();
         return false;
     }
 
@@ -115,43 +788,72 @@ bool DatabaseManager::addressExists(const QString &address) {
 }
 
 bool DatabaseManager::addAddress(const QString &address, const QVariantMap &data) {
-    QSqlDatabase db = getDatabase();
+    if (!ensureInitialized()) {
+        return false;
+    }
+
+    QSqlDatabase db = addressDatabase(address);
     if (!db.isOpen()) {
-        qWarning() << "Database is not open.";
+        qCWarning(lcDatabase) << "Database is not open.";
+        return false;
+    }
+
+    StringDictionary &dictionary = StringDictionary::instance();
+    const quint32 cityId = dictionary.idFor(data.value("city").toString());
+    const quint32 regionId = dictionary.idFor(data.value("region").toString());
+    const quint32 countryId = dictionary.idFor(data.value("country").toString());
+    const quint32 postalId = dictionary.idFor(data.value("postal").toString());
+    const quint32 timezoneId = dictionary.idFor(data.value("timezone").toString());
+
+    // New dictionary entries must exist on disk before rows refer to them
+    if (!persistDictionary()) {
+        return false;
+    }
+
+    const qint64 changeSeq = reserveChangeSequence(1);
+    if (changeSeq < 0) {
         return false;
     }
 
     QSqlQuery query(db);
     if (!query.prepare(R"(
-        INSERT INTO api_responses (address, hostname, city, region, country, loc, postal, timezone)
-        VALUES (:address, :hostname, :city, :region, :country, :loc, :postal, :timezone)
+        INSERT INTO api_responses (address, hostname, city, region, country, loc, postal, timezone, change_seq)
+        VALUES (:address, :hostname, :city, :region, :country, :loc, :postal, :timezone, :change_seq)
     )")) {
-        qWarning() << "Failed to prepare query for adding address:" << query.lastError().text();
+        qCWarning(lcDatabase) << "Failed to prepare query for adding address:" << query.lastError().text();
         return false;
     }
 
     query.bindValue(":address", address);
     query.bindValue(":hostname", data.value("hostname").toString());
-    query.bindValue(":city", data.value("city").toString());
-    query.bindValue(":region", data.value("region").toString());
-    query.bindValue(":country", data.value("country").toString());
+    query.bindValue(":city", cityId);
+    query.bindValue(":region", regionId);
+    query.bindValue(":country", countryId);
     query.bindValue(":loc", data.value("loc").toString());
-    query.bindValue(":postal", data.value("postal").toString());
-    query.bindValue(":timezone", data.value("timezone").toString());
+    query.bindValue(":postal", postalId);
+    query.bindValue(":timezone", timezoneId);
+    query.bindValue(":change_seq", changeSeq);
 
     if (!query.exec()) {
-        qWarning() << "Failed to insert new address:" << query.lastError().text();
+        qCWarning(lcDatabase) << "Failed to insert new address:" << query.lastError().text();
         return false;
     }
 
-    qDebug() << "Address added successfully:" << address;
+    if (addressFilterReady) {
+        addressFilter.insert(address);
+        if (addressFilter.isSaturated()) {
+            rebuildAddressFilter();
+        }
+    }
+
+    qCDebug(lcDatabase) << "Address added successfully:" << address;
     return true;
 }
 
 bool DatabaseManager::saveUniqueAddress(const QString &address, const QVariantMap &data) {
     // Check if the address already exists
     if (addressExists(address)) {
-        qDebug() << "Address already exists in the database:" << address;
+        qCDebug(lcDatabase) << "Address already exists in the database:" << address;
         return false;
     }
 
@@ -159,27 +861,27 @@ bool DatabaseManager::saveUniqueAddress(const QString &address, const QVariantMa
 }
 
 QList<QString> DatabaseManager::getAddressData() {
-    QSqlDatabase db = getDatabase();
-    QList<QString> addresses;
-
-    if (!db.isOpen()) {
-        qWarning() << "Database is not open!";
-        return addresses;
+    if (!ensureInitialized()) {
+        return {};
     }
 
-    if (!tableExists("api_responses")) {
-        qWarning() << "Table 'api_responses' does not exist!";
-        return addresses;
-    }
+    QList<QString> addresses;
 
-    QSqlQuery query(db);
-    if (!query.exec("SELECT address FROM api_responses")) {
-        qWarning() << "Failed to fetch saved addresses:" << query.lastError().text();
-        return addresses;
-    }
+    for (const QSqlDatabase &addressDb : addressDatabases()) {
+        if (!addressDb.isOpen()) {
+            qCWarning(lcDatabase) << "Database is not open!";
+            return addresses;
+        }
 
-    while (query.next()) {
-        addresses.append(query.value("address").toString());
+        QSqlQuery query(addressDb);
+        if (!query.exec("SELECT address FROM api_responses")) {
+            qCWarning(lcDatabase) << "Failed to fetch saved addresses:" << query.lastError().text();
+            return addresses;
+        }
+
+        while (query.next()) {
+            addresses.append(query.value("address").toString());
+        }
     }
 
     return addresses;
@@ -187,22 +889,30 @@ QList<QString> DatabaseManager::getAddressData() {
 
 bool DatabaseManager::tableExists(const QString &tableName) {
     if (!db.isOpen()) {
-        qWarning() << "Database is not open!";
+        qCWarning(lcDatabase) << "Database is not open!";
         return false;
     }
 
-    return db.tables().contains(tableName);
+    // Single indexed lookup instead of listing every table with db.tables()
+    QSqlQuery query(db);
+    query.prepare("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = :name");
+    query.bindValue(":name", tableName);
+    return query.exec() && query.next();
 }
 
 
 void DatabaseManager::logTables() {
+    if (!ensureInitialized()) {
+        return;
+    }
+
     QSqlDatabase db = QSqlDatabase::database("GeoCatchDB");
     if (!db.isOpen()) {
-        qWarning() << "Database is not open!";
+        qCWarning(lcDatabase) << "Database is not open!";
         return;
     }
 
-    qDebug() << "Tables in database:" << db.tables();
+    qCDebug(lcDatabase) << "Tables in database:" << db.tables();
 }
 
 QSqlDatabase DatabaseManager::getDatabase() const {
@@ -211,64 +921,646 @@ QSqlDatabase DatabaseManager::getDatabase() const {
     if (QSqlDatabase::contains(connectionName)) {
         return QSqlDatabase::database(connectionName);
     } else {
-        qWarning() << "Database connection" << connectionName << "does not exist!";
+        qCWarning(lcDatabase) << "Database connection" << connectionName << "does not exist!";
         return QSqlDatabase(); // Return a null database if connection doesn't exist
     }
 }
 
 bool DatabaseManager::dropDatabase() {
-    QSqlDatabase db = getDatabase();
-
-    if (!db.isOpen()) {
-        qWarning() << "Database is not open when clearing data.";
+    if (!ensureInitialized()) {
         return false;
     }
 
-    if (!tableExists("api_responses")) {
-        qWarning() << "Table 'api_responses' does not exist.";
-        return false;
-    }
+    // One shard at a time, so each delete only locks its own file
+    for (QSqlDatabase addressDb : addressDatabases()) {
+        if (!addressDb.isOpen()) {
+            qCWarning(lcDatabase) << "Database is not open when clearing data.";
+            return false;
+        }
 
-    QSqlQuery query(db);
-    if (!query.exec("DELETE FROM api_responses")) {
-        qWarning() << "Failed to clear database:" << query.lastError().text();
-        return false;
+        // Without the delete trigger SQLite can truncate the table in one step instead of
+        // updating the statistics row by row; the statistics are simply emptied alongside it
+        QSqlQuery query(addressDb);
+        const bool ok = addressDb.transaction()
+                        && query.exec("DROP TRIGGER IF EXISTS response_stats_delete")
+                        && query.exec("DELETE FROM api_responses")
+                        && query.exec("DELETE FROM response_stats")
+                        && createStatisticsTables(addressDb, false)
+                        && addressDb.commit();
+
+        if (!ok) {
+            qCWarning(lcDatabase) << "Failed to clear database:" << query.lastError().text();
+            addressDb.rollback();
+            return false;
+        }
     }
 
-    qDebug() << "Database cleared successfully.";
+    addressFilter.reset(1024);
+    addressFilterReady = true;
+    recordCache.clear();
+    QFile::remove(databasePath + ".bloom");
+
+    qCDebug(lcDatabase) << "Database cleared successfully.";
     return true;
 }
 
 QVariantMap DatabaseManager::getSpecificAddressData(const QString &address) {
-    QSqlDatabase db = getDatabase();
+    if (!ensureInitialized()) {
+        return {};
+    }
+
+    if (const QVariantMap *cached = recordCache.object(address)) {
+        GEOCATCH_TRACE("db.lookup.cached", address.size(), 0);
+        return *cached;
+    }
+
+    if (addressFilterReady && !addressFilter.mayContain(address)) {
+        GEOCATCH_TRACE("db.lookup.filtered", address.size(), 0);
+        qCDebug(lcDatabase) << "No data found for address:" << address;
+        return {};
+    }
+
+    QSqlDatabase db = addressDatabase(address);
     if (!db.isOpen()) {
-        qDebug() << "Database is not open!";
+        qCDebug(lcDatabase) << "Database is not open!";
         return {};
     }
 
     QSqlQuery query(db);
+    GEOCATCH_TRACE("db.lookup.query", address.size(), 0);
     query.prepare("SELECT * FROM api_responses WHERE address = :address");
     query.bindValue(":address", address);
 
     if (!query.exec()) {
-        qDebug() << "Database query failed:" << query.lastError().text();
+        qCDebug(lcDatabase) << "Database query failed:" << query.lastError().text();
         return {};
     }
 
     if (query.next()) {
+        const StringDictionary &dictionary = StringDictionary::instance();
+        auto decode = [&query, &dictionary](const char *field) {
+            const QVariant id = query.value(field);
+            return id.isNull() ? QString() : dictionary.value(id.toUInt());
+        };
+
         QVariantMap data;
         data["address"] = query.value("address").toString();
         data["hostname"] = query.value("hostname").toString();
-        data["city"] = query.value("city").toString();
-        data["region"] = query.value("region").toString();
-        data["country"] = query.value("country").toString();
+        data["city"] = decode("city");
+        data["region"] = decode("region");
+        data["country"] = decode("country");
         data["loc"] = query.value("loc").toString();
-        data["postal"] = query.value("postal").toString();
-        data["timezone"] = query.value("timezone").toString();
-        qDebug() << "Retrieved data from database:" << data;
+        data["postal"] = decode("postal");
+        data["timezone"] = decode("timezone");
+        qCDebug(lcDatabase) << "Retrieved data from database:" << data;
+        recordCache.insert(address, new QVariantMap(data));
         return data;
     }
 
-    qDebug() << "No data found for address:" << address;
+    qCDebug(lcDatabase) << "No data found for address:" << address;
     return {};
 }
+
+qint64 DatabaseManager::beginImport(const QString &source) {
+    if (!ensureInitialized()) {
+        return -1;
+    }
+
+    QSqlDatabase db = getDatabase();
+    if (!db.isOpen()) {
+        qCWarning(lcDatabase) << "Database is not open when starting import.";
+        return -1;
+    }
+
+    // Progress lives in the catalog, staged rows next to the api_responses table they merge into
+    QSqlQuery query(db);
+    if (!query.exec(R"(
+            CREATE TABLE IF NOT EXISTS import_progress (
+                id INTEGER PRIMARY KEY CHECK (id = 0),
+                source TEXT NOT NULL,
+                byte_offset INTEGER NOT NULL
+            )
+        )")) {
+        qCWarning(lcDatabase) << "Failed to create import tables:" << query.lastError().text();
+        return -1;
+    }
+
+    // The staging table has no constraints or indexes so batches append cheaply;
+    // uniqueness is enforced once by finishImport()
+    for (const QSqlDatabase &addressDb : addressDatabases()) {
+        QSqlQuery staging(addressDb);
+        if (!staging.exec(R"(
+                CREATE TABLE IF NOT EXISTS import_staging (
+                    address TEXT,
+                    hostname TEXT,
+                    city INTEGER,
+                    region INTEGER,
+                    country INTEGER,
+                    loc TEXT,
+                    postal INTEGER,
+                    timezone INTEGER
+                )
+            )")) {
+            qCWarning(lcDatabase) << "Failed to create import tables:" << staging.lastError().text();
+            return -1;
+        }
+    }
+
+    if (!query.exec("SELECT source, byte_offset FROM import_progress WHERE id = 0")) {
+        qCWarning(lcDatabase) << "Failed to read import progress:" << query.lastError().text();
+        return -1;
+    }
+
+    if (query.next()) {
+        if (query.value(0).toString() == source) {
+            return query.value(1).toLongLong();
+        }
+        qCDebug(lcDatabase) << "Discarding unfinished import of" << query.value(0).toString();
+    }
+    query.finish();
+
+    for (const QSqlDatabase &addressDb : addressDatabases()) {
+        QSqlQuery staging(addressDb);
+        if (!staging.exec("DELETE FROM import_staging")) {
+            qCWarning(lcDatabase) << "Failed to reset import state:" << staging.lastError().text();
+            return -1;
+        }
+    }
+
+    if (!query.exec("DELETE FROM import_progress")) {
+        qCWarning(lcDatabase) << "Failed to reset import state:" << query.lastError().text();
+        return -1;
+    }
+    return 0;
+}
+
+bool DatabaseManager::stageImportBatch(const QString &source, const QList<AddressRecord> &records, qint64 endOffset) {
+    if (!ensureInitialized()) {
+        return false;
+    }
+
+    // Dictionary entries are committed first so no shard can commit rows that refer to missing IDs
+    if (!persistDictionary()) {
+        return false;
+    }
+
+    QSqlDatabase db = getDatabase();
+    if (!db.transaction()) {
+        qCWarning(lcDatabase) << "Failed to start import transaction:" << db.lastError().text();
+        return false;
+    }
+
+    bool ok = true;
+    if (shardConnectionNames.isEmpty()) {
+        ok = insertRecords(db, "import_staging", records);
+    } else {
+        // Shard files commit before the catalog records the offset. A crash in between only
+        // re-stages the batch on resume, and finishImport() ignores the duplicate rows.
+        QList<QList<AddressRecord>> partitions(shardConnectionNames.size());
+        for (const AddressRecord &record : records) {
+            partitions[shardIndex(record.address)].append(record);
+        }
+
+        ok = forEachShardInParallel([&partitions](QSqlDatabase &shardDb, int shard) {
+            if (partitions.at(shard).isEmpty()) {
+                return true;
+            }
+            if (!shardDb.transaction()) {
+                return false;
+            }
+            if (!insertRecords(shardDb, "import_staging", partitions.at(shard))) {
+                shardDb.rollback();
+                return false;
+            }
+            return shardDb.commit();
+        });
+    }
+
+    QSqlQuery progress(db);
+    ok = ok && progress.prepare("INSERT OR REPLACE INTO import_progress (id, source, byte_offset) VALUES (0, :source, :offset)");
+    if (ok) {
+        progress.bindValue(":source", source);
+        progress.bindValue(":offset", endOffset);
+        ok = progress.exec();
+    }
+
+    if (!ok) {
+        qCWarning(lcDatabase) << "Failed to stage import batch:" << progress.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    return db.commit();
+}
+
+qint64 DatabaseManager::mergeStagedRecords(QSqlDatabase &addressDb, qint64 firstChangeSeq) {
+    if (!addressDb.transaction()) {
+        qCWarning(lcDatabase) << "Failed to start import merge:" << addressDb.lastError().text();
+        return -1;
+    }
+
+    // Sorted insert keeps the address index build mostly sequential. Rows skipped as duplicates
+    // leave gaps in the reserved sequence range, which is harmless.
+    QSqlQuery query(addressDb);
+    bool ok = query.prepare(R"(
+        INSERT OR IGNORE INTO api_responses (address, hostname, city, region, country, loc, postal, timezone, change_seq)
+        SELECT address, hostname, city, region, country, loc, postal, timezone,
+               :first - 1 + ROW_NUMBER() OVER (ORDER BY address)
+        FROM import_staging ORDER BY address
+    )");
+    query.bindValue(":first", firstChangeSeq);
+    ok = ok && query.exec();
+    const qint64 inserted = ok ? query.numRowsAffected() : -1;
+
+    ok = ok && query.exec("DELETE FROM import_staging");
+    if (!ok) {
+        qCWarning(lcDatabase) << "Failed to merge imported rows:" << query.lastError().text();
+        addressDb.rollback();
+        return -1;
+    }
+
+    if (!addressDb.commit()) {
+        qCWarning(lcDatabase) << "Failed to commit import merge:" << addressDb.lastError().text();
+        return -1;
+    }
+    return inserted;
+}
+
+qint64 DatabaseManager::finishImport() {
+    if (!ensureInitialized()) {
+        return -1;
+    }
+
+    // Each address database gets its own range of change sequence numbers up front
+    QList<qint64> firstChangeSeqs;
+    for (const QSqlDatabase &addressDb : addressDatabases()) {
+        QSqlQuery count(addressDb);
+        if (!count.exec("SELECT COUNT(*) FROM import_staging") || !count.next()) {
+            qCWarning(lcDatabase) << "Failed to count staged rows:" << count.lastError().text();
+            return -1;
+        }
+        const qint64 first = reserveChangeSequence(count.value(0).toLongLong());
+        if (first < 0) {
+            return -1;
+        }
+        firstChangeSeqs.append(first);
+    }
+
+    qint64 inserted = 0;
+    if (shardConnectionNames.isEmpty()) {
+        QSqlDatabase db = getDatabase();
+        inserted = mergeStagedRecords(db, firstChangeSeqs.first());
+    } else {
+        QAtomicInteger<qint64> shardRows = 0;
+        const bool merged = forEachShardInParallel([&shardRows, &firstChangeSeqs](QSqlDatabase &shardDb, int shard) {
+            const qint64 rows = mergeStagedRecords(shardDb, firstChangeSeqs.at(shard));
+            shardRows.fetchAndAddRelaxed(qMax<qint64>(rows, 0));
+            return rows >= 0;
+        });
+        inserted = merged ? shardRows.loadRelaxed() : -1;
+    }
+
+    // Rebuilt even on failure: shards that merged before another one failed have committed
+    // their rows. A failed rebuild leaves the filter disabled, so it is not saved either.
+    rebuildAddressFilter();
+
+    // Progress is kept on failure so a rerun resumes instead of restaging everything
+    QSqlQuery query(getDatabase());
+    if (inserted < 0 || !query.exec("DELETE FROM import_progress")) {
+        return -1;
+    }
+
+    qCDebug(lcDatabase) << "Import merged" << inserted << "new addresses.";
+    return inserted;
+}
+
+QVariantList DatabaseManager::getGroupCounts(const QString &dimension) {
+    if (!ensureInitialized()) {
+        return {};
+    }
+
+    QVariantList groups;
+    QList<std::pair<quint32, qint64>> counts;
+    QHash<quint32, qsizetype> positions;
+
+    // Each shard counts its own rows; dictionary IDs are shared, so merging is a sum per ID
+    for (const QSqlDatabase &addressDb : addressDatabases()) {
+        if (!addressDb.isOpen()) {
+            qCWarning(lcDatabase) << "Database is not open!";
+            return groups;
+        }
+
+        QSqlQuery query(addressDb);
+        query.setForwardOnly(true);
+        query.prepare("SELECT value_id, count FROM response_stats WHERE dimension = :dimension AND count > 0");
+        query.bindValue(":dimension", dimension);
+        if (!query.exec()) {
+            qCWarning(lcDatabase) << "Failed to read statistics:" << query.lastError().text();
+            return groups;
+        }
+
+        while (query.next()) {
+            const quint32 id = query.value(0).toUInt();
+            const auto position = positions.constFind(id);
+            if (position == positions.cend()) {
+                positions.insert(id, counts.size());
+                counts.append({id, query.value(1).toLongLong()});
+            } else {
+                counts[*position].second += query.value(1).toLongLong();
+            }
+        }
+    }
+
+    std::sort(counts.begin(), counts.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+
+    const StringDictionary &dictionary = StringDictionary::instance();
+    for (const auto &[id, count] : counts) {
+        QVariantMap group;
+        group["value"] = dictionary.value(id);
+        group["count"] = count;
+        groups.append(group);
+    }
+    return groups;
+}
+
+qint64 DatabaseManager::getAddressCount() {
+    if (!ensureInitialized()) {
+        return 0;
+    }
+
+    qint64 total = 0;
+    for (const QSqlDatabase &addressDb : addressDatabases()) {
+        QSqlQuery query(addressDb);
+        if (!query.exec("SELECT COALESCE(SUM(count), 0) FROM response_stats WHERE dimension = 'country'") || !query.next()) {
+            qCWarning(lcDatabase) << "Failed to read address count:" << query.lastError().text();
+            return 0;
+        }
+        total += query.value(0).toLongLong();
+    }
+    return total;
+}
+
+void DatabaseManager::recordLookup() {
+    if (!ensureInitialized()) {
+        return;
+    }
+
+    QSqlQuery query(getDatabase());
+    query.prepare(R"(
+        INSERT INTO lookup_volume VALUES (:hour, 1)
+        ON CONFLICT (hour) DO UPDATE SET lookups = lookups + 1
+    )");
+    query.bindValue(":hour", QDateTime::currentSecsSinceEpoch() / 3600);
+    if (!query.exec()) {
+        qCWarning(lcDatabase) << "Failed to record lookup:" << query.lastError().text();
+    }
+}
+
+void DatabaseManager::recordAddressLookup(const QString &address) {
+    if (!ensureInitialized()) {
+        return;
+    }
+
+    // Kept in the main file, so the history survives dropDatabase() and can refill the store
+    QSqlQuery query(getDatabase());
+    query.prepare(R"(
+        INSERT INTO lookup_history VALUES (:address, 1, :now)
+        ON CONFLICT (address) DO UPDATE SET lookups = lookups + 1, last_lookup = excluded.last_lookup
+    )");
+    query.bindValue(":address", address);
+    query.bindValue(":now", QDateTime::currentSecsSinceEpoch());
+    if (!query.exec()) {
+        qCWarning(lcDatabase) << "Failed to record address lookup:" << query.lastError().text();
+    }
+}
+
+QStringList DatabaseManager::getHotAddresses(int limit) {
+    if (!ensureInitialized()) {
+        return {};
+    }
+
+    // Lookup count, discounted by one for every day since the address was last looked up
+    QStringList addresses;
+    QSqlQuery query(getDatabase());
+    query.setForwardOnly(true);
+    query.prepare(R"(
+        SELECT address FROM lookup_history
+        ORDER BY lookups / (1.0 + (:now - last_lookup) / 86400.0) DESC
+        LIMIT :limit
+    )");
+    query.bindValue(":now", QDateTime::currentSecsSinceEpoch());
+    query.bindValue(":limit", limit);
+    if (!query.exec()) {
+        qCWarning(lcDatabase) << "Failed to read lookup history:" << query.lastError().text();
+        return addresses;
+    }
+
+    while (query.next()) {
+        addresses.append(query.value(0).toString());
+    }
+    return addresses;
+}
+
+QVariantList DatabaseManager::getLookupVolume(int hours) {
+    if (!ensureInitialized()) {
+        return {};
+    }
+
+    QVariantList volume;
+    QSqlQuery query(getDatabase());
+    query.setForwardOnly(true);
+    query.prepare("SELECT hour, lookups FROM lookup_volume WHERE hour >= :since ORDER BY hour");
+    query.bindValue(":since", QDateTime::currentSecsSinceEpoch() / 3600 - hours + 1);
+    if (!query.exec()) {
+        qCWarning(lcDatabase) << "Failed to read lookup volume:" << query.lastError().text();
+        return volume;
+    }
+
+    while (query.next()) {
+        QVariantMap bucket;
+        bucket["time"] = QDateTime::fromSecsSinceEpoch(query.value(0).toLongLong() * 3600);
+        bucket["lookups"] = query.value(1).toLongLong();
+        volume.append(bucket);
+    }
+    return volume;
+}
+
+bool DatabaseManager::forEachRecord(const std::function<bool(const AddressRecord &)> &visit) {
+    if (!ensureInitialized()) {
+        return false;
+    }
+
+    for (const QSqlDatabase &addressDb : addressDatabases()) {
+        QSqlQuery query(addressDb);
+        query.setForwardOnly(true);
+        if (!query.exec("SELECT address, hostname, city, region, country, loc, postal, timezone, change_seq FROM api_responses")) {
+            qCWarning(lcDatabase) << "Failed to read records:" << query.lastError().text();
+            return false;
+        }
+
+        AddressRecord record;
+        while (query.next()) {
+            record.address = query.value(0).toString();
+            record.hostname = query.value(1).toString();
+            record.city = query.value(2).toUInt();
+            record.region = query.value(3).toUInt();
+            record.country = query.value(4).toUInt();
+            record.loc = query.value(5).toString();
+            record.postal = query.value(6).toUInt();
+            record.timezone = query.value(7).toUInt();
+            record.changeSeq = query.value(8).toLongLong();
+            if (!visit(record)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+QList<AddressRecord> DatabaseManager::getChangesSince(qint64 changeSeq, int limit) {
+    if (!ensureInitialized()) {
+        return {};
+    }
+
+    // Every database returns its own first rows after changeSeq; the smallest overall win
+    QList<AddressRecord> changes;
+    for (const QSqlDatabase &addressDb : addressDatabases()) {
+        QSqlQuery query(addressDb);
+        query.setForwardOnly(true);
+        query.prepare(R"(
+            SELECT address, hostname, city, region, country, loc, postal, timezone, change_seq
+            FROM api_responses WHERE change_seq > :since ORDER BY change_seq LIMIT :limit
+        )");
+        query.bindValue(":since", changeSeq);
+        query.bindValue(":limit", limit);
+        if (!query.exec()) {
+            qCWarning(lcDatabase) << "Failed to read changes:" << query.lastError().text();
+            return {};
+        }
+
+        while (query.next()) {
+            AddressRecord record;
+            record.address = query.value(0).toString();
+            record.hostname = query.value(1).toString();
+            record.city = query.value(2).toUInt();
+            record.region = query.value(3).toUInt();
+            record.country = query.value(4).toUInt();
+            record.loc = query.value(5).toString();
+            record.postal = query.value(6).toUInt();
+            record.timezone = query.value(7).toUInt();
+            record.changeSeq = query.value(8).toLongLong();
+            changes.append(std::move(record));
+        }
+    }
+
+    if (!shardConnectionNames.isEmpty()) {
+        std::sort(changes.begin(), changes.end(), [](const AddressRecord &a, const AddressRecord &b) {
+            return a.changeSeq < b.changeSeq;
+        });
+        if (changes.size() > limit) {
+            changes.resize(limit);
+        }
+    }
+    return changes;
+}
+
+qint64 DatabaseManager::mergeChanges(const QList<AddressRecord> &records) {
+    if (!ensureInitialized()) {
+        return -1;
+    }
+
+    if (records.isEmpty()) {
+        return 0;
+    }
+
+    const QList<QSqlDatabase> databases = addressDatabases();
+    QList<QList<AddressRecord>> partitions(databases.size());
+    for (const AddressRecord &record : records) {
+        partitions[shardConnectionNames.isEmpty() ? 0 : shardIndex(record.address)].append(record);
+    }
+
+    const qint64 firstChangeSeq = persistDictionary() ? reserveChangeSequence(records.size()) : -1;
+    if (firstChangeSeq < 0) {
+        return -1;
+    }
+
+    // Addresses that are already stored keep their local data, so merging the same delta twice is a no-op
+    qint64 inserted = 0;
+    qint64 nextChangeSeq = firstChangeSeq;
+    for (qsizetype i = 0; i < databases.size(); ++i) {
+        if (partitions.at(i).isEmpty()) {
+            continue;
+        }
+
+        QSqlDatabase addressDb = databases.at(i);
+        QSqlQuery insert(addressDb);
+        bool ok = addressDb.transaction()
+                  && insert.prepare(R"(
+                         INSERT OR IGNORE INTO api_responses
+                             (address, hostname, city, region, country, loc, postal, timezone, change_seq)
+                         VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
+                     )");
+
+        for (const AddressRecord &record : partitions.at(i)) {
+            if (!ok) {
+                break;
+            }
+            insert.bindValue(0, record.address);
+            insert.bindValue(1, record.hostname);
+            insert.bindValue(2, record.city);
+            insert.bindValue(3, record.region);
+            insert.bindValue(4, record.country);
+            insert.bindValue(5, record.loc);
+            insert.bindValue(6, record.postal);
+            insert.bindValue(7, record.timezone);
+            insert.bindValue(8, nextChangeSeq++);
+            ok = insert.exec();
+            inserted += ok ? insert.numRowsAffected() : 0;
+        }
+
+        if (!ok || !addressDb.commit()) {
+            qCWarning(lcDatabase) << "Failed to merge changes:" << insert.lastError().text();
+            addressDb.rollback();
+            return -1;
+        }
+
+        // Shards commit independently, so each one is added to the filter as soon as it is durable
+        if (addressFilterReady) {
+            for (const AddressRecord &record : partitions.at(i)) {
+                addressFilter.insert(record.address);
+            }
+        }
+    }
+
+    if (addressFilterReady && addressFilter.isSaturated()) {
+        rebuildAddressFilter();
+    }
+
+    qCDebug(lcDatabase) << "Merged" << inserted << "of" << records.size() << "changed addresses.";
+    return inserted;
+}
+
+bool DatabaseManager::compactStorage() {
+    if (!ensureInitialized()) {
+        return false;
+    }
+
+    // VACUUM rewrites the whole file, so shards go one at a time to bound the extra disk space
+    QList<QSqlDatabase> databases = addressDatabases();
+    if (!shardConnectionNames.isEmpty()) {
+        databases.prepend(getDatabase());
+    }
+
+    for (const QSqlDatabase &database : std::as_const(databases)) {
+        QElapsedTimer timer;
+        timer.start();
+
+        QSqlQuery query(database);
+        if (!query.exec("VACUUM")) {
+            qCWarning(lcDatabase) << "Failed to compact" << database.databaseName() << ":" << query.lastError().text();
+            return false;
+        }
+        qCDebug(lcDatabase) << "Compacted" << database.databaseName() << "in" << timer.elapsed() << "ms";
+    }
+    return true;
+}
@@ -0,0 +1,270 @@
+#include "datasetImporter.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <cstring>
+
+#include "databaseManager.h"
+#include "stringDictionary.h"
+#include "ipScanner.h"
+#include "traceBuffer.h"
+
+namespace {
+
+enum Field { Address, Hostname, City, Region, Country, Loc, Postal, Timezone, Latitude, Longitude, FieldCount };
+
+struct Chunk {
+    qint64 begin = 0;
+    qint64 end = 0;
+};
+
+struct ChunkResult {
+    QList<AddressRecord> records;
+    qint64 skipped = 0;
+};
+
+Field fieldForName(const QByteArray &rawName) {
+    const QByteArray name = rawName.trimmed().toLower();
+    if (name == "ip" || name == "address") return Address;
+    if (name == "hostname") return Hostname;
+    if (name == "city") return City;
+    if (name == "region") return Region;
+    if (name == "country") return Country;
+    if (name == "loc") return Loc;
+    if (name == "postal") return Postal;
+    if (name == "timezone") return Timezone;
+    if (name == "lat" || name == "latitude") return Latitude;
+    if (name == "lon" || name == "lng" || name == "longitude") return Longitude;
+    return FieldCount; // Column is ignored
+}
+
+QList<QByteArray> splitCsvLine(QByteArrayView line) {
+    QList<QByteArray> fields;
+    QByteArray field;
+    bool quoted = false;
+
+    for (qsizetype i = 0; i < line.size(); ++i) {
+        const char c = line[i];
+        if (quoted) {
+            if (c != '"') {
+                field += c;
+            } else if (i + 1 < line.size() && line[i + 1] == '"') {
+                field += '"';
+                ++i;
+            } else {
+                quoted = false;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.append(field);
+            field.clear();
+        } else {
+            field += c;
+        }
+    }
+    fields.append(field);
+    return fields;
+}
+
+bool makeRecord(const QByteArray (&values)[FieldCount], AddressRecord &record) {
+    const QByteArray address = values[Address].trimmed();
+    quint32 ipv4 = 0;
+    if (IpScanner::parseIpv4(address.constData(), address.size(), &ipv4)) {
+        // Canonical dotted form, so "010.001.002.003" matches lookups of "10.1.2.3"
+        record.address = QString::fromLatin1(IpScanner::toByteArray(ipv4));
+    } else {
+        // IPv6 rows are stored in the same canonical form as looked-up AAAA addresses
+        const QHostAddress ipv6(QString::fromLatin1(address));
+        if (ipv6.protocol() != QAbstractSocket::IPv6Protocol) {
+            return false;
+        }
+        record.address = ipv6.toString();
+    }
+
+    StringDictionary &dictionary = StringDictionary::instance();
+    record.hostname = QString::fromUtf8(values[Hostname]);
+    record.loc = !values[Loc].isEmpty() || values[Latitude].isEmpty()
+                     ? QString::fromUtf8(values[Loc])
+                     : QString::fromUtf8(values[Latitude] + ',' + values[Longitude]);
+    record.city = dictionary.idFor(QString::fromUtf8(values[City]));
+    record.region = dictionary.idFor(QString::fromUtf8(values[Region]));
+    record.country = dictionary.idFor(QString::fromUtf8(values[Country]));
+    record.postal = dictionary.idFor(QString::fromUtf8(values[Postal]));
+    record.timezone = dictionary.idFor(QString::fromUtf8(values[Timezone]));
+    return true;
+}
+
+bool parseJsonLine(QByteArrayView line, AddressRecord &record) {
+    const QJsonObject object = QJsonDocument::fromJson(QByteArray::fromRawData(line.data(), line.size())).object();
+    if (object.isEmpty()) {
+        return false;
+    }
+
+    QByteArray values[FieldCount];
+    for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+        const Field field = fieldForName(it.key().toUtf8());
+        if (field != FieldCount) {
+            values[field] = it.value().isDouble() ? QByteArray::number(it.value().toDouble(), 'g', 10)
+                                                  : it.value().toString().toUtf8();
+        }
+    }
+    return makeRecord(values, record);
+}
+
+bool parseCsvLine(QByteArrayView line, const QList<Field> &columns, AddressRecord &record) {
+    const QList<QByteArray> fields = splitCsvLine(line);
+    QByteArray values[FieldCount];
+    for (qsizetype i = 0; i < fields.size() && i < columns.size(); ++i) {
+        if (columns[i] != FieldCount) {
+            values[columns[i]] = fields[i];
+        }
+    }
+    return makeRecord(values, record);
+}
+
+ChunkResult parseChunk(const char *text, const Chunk &chunk, bool jsonLines, const QList<Field> &columns) {
+    ChunkResult result;
+    qint64 lineStart = chunk.begin;
+
+    while (lineStart < chunk.end) {
+        const void *newline = std::memchr(text + lineStart, '\n', size_t(chunk.end - lineStart));
+        const qint64 lineEnd = newline ? static_cast<const char *>(newline) - text : chunk.end;
+
+        QByteArrayView line(text + lineStart, lineEnd - lineStart);
+        if (line.endsWith('\r')) {
+            line.chop(1);
+        }
+
+        if (!line.trimmed().isEmpty()) {
+            AddressRecord record;
+            const bool ok = jsonLines ? parseJsonLine(line, record) : parseCsvLine(line, columns, record);
+            if (ok) {
+                result.records.append(std::move(record));
+            } else {
+                ++result.skipped;
+            }
+        }
+        lineStart = lineEnd + 1;
+    }
+
+    return result;
+}
+
+} // namespace
+
+DatasetImporter::DatasetImporter(QObject *parent) : QObject(parent) {}
+
+void DatasetImporter::setChunkSize(qint64 bytes) {
+    chunkSize = qMax<qint64>(bytes, 64 * 1024);
+}
+
+DatasetImporter::Summary DatasetImporter::importFile(const QString &path) {
+    Summary summary;
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        emit debugMessage("Failed to open dataset: " + path);
+        return summary;
+    }
+
+    const qint64 size = file.size();
+    const uchar *mapped = size > 0 ? file.map(0, size) : nullptr;
+    if (!mapped) {
+        emit debugMessage("Failed to map dataset: " + path);
+        return summary;
+    }
+    const char *text = reinterpret_cast<const char *>(mapped);
+
+    // Progress is only reused for the exact same file contents
+    const QFileInfo info(file);
+    const QString source = info.canonicalFilePath() + ':' + QString::number(size) + ':'
+                           + QString::number(info.lastModified().toMSecsSinceEpoch());
+    const bool jsonLines = path.endsWith(".jsonl", Qt::CaseInsensitive)
+                           || path.endsWith(".ndjson", Qt::CaseInsensitive);
+
+    DatabaseManager &database = DatabaseManager::instance();
+    qint64 offset = database.beginImport(source);
+    if (offset < 0) {
+        emit debugMessage("Failed to prepare the database for import.");
+        return summary;
+    }
+    summary.resumed = offset > 0;
+
+    QList<Field> columns;
+    if (!jsonLines) {
+        const void *newline = std::memchr(text, '\n', size_t(size));
+        const qint64 headerEnd = newline ? static_cast<const char *>(newline) - text : size;
+        for (const QByteArray &name : splitCsvLine(QByteArrayView(text, headerEnd).trimmed())) {
+            columns.append(fieldForName(name));
+        }
+        if (!columns.contains(Address)) {
+            emit debugMessage("CSV header has no ip or address column: " + path);
+            return summary;
+        }
+        offset = qMax(offset, headerEnd + 1);
+    }
+
+    // Each batch keeps every pool thread busy twice over, then commits in one transaction
+    const int chunksPerBatch = qMax(QThreadPool::globalInstance()->maxThreadCount(), 1) * 2;
+    auto parse = [text, jsonLines, &columns](const Chunk &chunk) {
+        return parseChunk(text, chunk, jsonLines, columns);
+    };
+
+    while (offset < size) {
+        QList<Chunk> chunks;
+        qint64 begin = offset;
+        while (begin < size && chunks.size() < chunksPerBatch) {
+            qint64 end = qMin(begin + chunkSize, size);
+            if (end < size) {
+                const void *newline = std::memchr(text + end, '\n', size_t(size - end));
+                end = newline ? static_cast<const char *>(newline) - text + 1 : size;
+            }
+            chunks.append({begin, end});
+            begin = end;
+        }
+
+        const QList<ChunkResult> results = QtConcurrent::blockingMapped<QList<ChunkResult>>(chunks, parse);
+        GEOCATCH_TRACE("import.batch.parsed", chunks.size(), begin - offset);
+
+        QList<AddressRecord> records;
+        for (const ChunkResult &result : results) {
+            records.append(result.records);
+            summary.parsedRows += result.records.size() + result.skipped;
+            summary.skippedRows += result.skipped;
+        }
+
+        if (!database.stageImportBatch(source, records, begin)) {
+            emit debugMessage("Import interrupted at byte " + QString::number(offset) + ", rerun to resume.");
+            summary.seconds = timer.nsecsElapsed() / 1e9;
+            return summary;
+        }
+
+        GEOCATCH_TRACE("import.batch.staged", records.size(), begin);
+        offset = begin;
+        summary.seconds = timer.nsecsElapsed() / 1e9;
+        emit progress(offset, size, summary.rowsPerSecond());
+    }
+
+    file.unmap(const_cast<uchar *>(mapped));
+
+    summary.insertedRows = database.finishImport();
+    summary.seconds = timer.nsecsElapsed() / 1e9;
+    summary.ok = summary.insertedRows >= 0;
+
+    emit debugMessage("Imported " + QString::number(summary.parsedRows) + " rows in "
+                      + QString::number(summary.seconds, 'f', 2) + " s ("
+                      + QString::number(summary.rowsPerSecond(), 'f', 0) + " rows/s), "
+                      + QString::number(summary.insertedRows) + " new addresses.");
+    return summary;
+}
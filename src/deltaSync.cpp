@@ -0,0 +1,152 @@
+#include "deltaSync.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include "databaseManager.h"
+#include "stringDictionary.h"
+
+namespace {
+constexpr quint32 fileMagic = 0x4743444C; // "GCDL"
+constexpr quint32 fileVersion = 1;
+constexpr int recordsPerBlock = 4096;      ///< Records per compressed block, also the read page size.
+}
+
+DeltaSync::DeltaSync(QObject *parent) : QObject(parent) {}
+
+qint64 DeltaSync::exportChanges(const QString &path, qint64 sinceChangeSeq) {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        emit debugMessage("Failed to open delta file for writing: " + path);
+        return -1;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_5);
+    out << fileMagic << fileVersion << sinceChangeSeq;
+
+    DatabaseManager &database = DatabaseManager::instance();
+    const StringDictionary &dictionary = StringDictionary::instance();
+    qint64 lastChangeSeq = sinceChangeSeq;
+    qint64 exported = 0;
+
+    while (true) {
+        const QList<AddressRecord> records = database.getChangesSince(lastChangeSeq, recordsPerBlock);
+        if (records.isEmpty()) {
+            break;
+        }
+
+        QByteArray lines;
+        for (const AddressRecord &record : records) {
+            QJsonObject object;
+            object["ip"] = record.address;
+            object["hostname"] = record.hostname;
+            object["city"] = dictionary.value(record.city);
+            object["region"] = dictionary.value(record.region);
+            object["country"] = dictionary.value(record.country);
+            object["loc"] = record.loc;
+            object["postal"] = dictionary.value(record.postal);
+            object["timezone"] = dictionary.value(record.timezone);
+            lines += QJsonDocument(object).toJson(QJsonDocument::Compact);
+            lines += '\n';
+        }
+
+        out << qCompress(lines);
+        lastChangeSeq = records.last().changeSeq;
+        exported += records.size();
+    }
+
+    // An empty block ends the stream, followed by the cursor for the next export
+    out << QByteArray() << lastChangeSeq;
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        emit debugMessage("Failed to write delta file: " + path);
+        return -1;
+    }
+
+    emit debugMessage("Exported " + QString::number(exported) + " changed addresses up to sequence "
+                      + QString::number(lastChangeSeq) + ".");
+    return lastChangeSeq;
+}
+
+qint64 DeltaSync::importChanges(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        emit debugMessage("Failed to open delta file: " + path);
+        return -1;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_5);
+
+    quint32 magic = 0, version = 0;
+    qint64 sinceChangeSeq = 0;
+    in >> magic >> version >> sinceChangeSeq;
+    if (in.status() != QDataStream::Ok || magic != fileMagic || version != fileVersion) {
+        emit debugMessage("Not a GeoCatch delta file: " + path);
+        return -1;
+    }
+
+    // Storage must be open before records take dictionary IDs, see StringDictionary::restore()
+    DatabaseManager &database = DatabaseManager::instance();
+    if (!database.initializeDatabase()) {
+        emit debugMessage("Failed to open the database for merging: " + path);
+        return -1;
+    }
+
+    StringDictionary &dictionary = StringDictionary::instance();
+    qint64 received = 0;
+    qint64 inserted = 0;
+
+    while (true) {
+        QByteArray block;
+        in >> block;
+        if (in.status() != QDataStream::Ok) {
+            emit debugMessage("Delta file is truncated: " + path);
+            return -1;
+        }
+        if (block.isEmpty()) {
+            break;
+        }
+
+        const QByteArray lines = qUncompress(block);
+        if (lines.isEmpty()) {
+            emit debugMessage("Delta file is corrupt: " + path);
+            return -1;
+        }
+
+        QList<AddressRecord> records;
+        for (const QByteArray &line : lines.split('\n')) {
+            const QJsonObject object = QJsonDocument::fromJson(line).object();
+            const QString address = object.value("ip").toString();
+            if (address.isEmpty()) {
+                continue;
+            }
+
+            AddressRecord record;
+            record.address = address;
+            record.hostname = object.value("hostname").toString();
+            record.city = dictionary.idFor(object.value("city").toString());
+            record.region = dictionary.idFor(object.value("region").toString());
+            record.country = dictionary.idFor(object.value("country").toString());
+            record.loc = object.value("loc").toString();
+            record.postal = dictionary.idFor(object.value("postal").toString());
+            record.timezone = dictionary.idFor(object.value("timezone").toString());
+            records.append(std::move(record));
+        }
+
+        const qint64 merged = database.mergeChanges(records);
+        if (merged < 0) {
+            emit debugMessage("Failed to merge delta file: " + path);
+            return -1;
+        }
+        received += records.size();
+        inserted += merged;
+    }
+
+    emit debugMessage("Merged " + QString::number(inserted) + " new of " + QString::number(received)
+                      + " changed addresses.");
+    return inserted;
+}
@@ -0,0 +1,97 @@
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <QList>
+#include <QString>
+#include <QStringView>
+#include <QtGlobal>
+
+/**
+ * @class BloomFilter
+ * @brief Cache-blocked Bloom filter for fast negative lookups of string keys.
+ *
+ * Each key maps to a single 512-bit block (one cache line) and sets a fixed number of bits
+ * inside it, so a lookup touches one cache line. mayContain() never returns false for a key
+ * that was inserted; it returns true for a key that was not inserted with a small probability.
+ *
+ * Keys are hashed with stableKeyHash(), so a filter saved to disk stays valid across runs.
+ */
+class BloomFilter {
+public:
+    /**
+     * @brief Construct a filter sized for the expected number of keys.
+     * @param expectedItems Number of keys the filter should hold before it is considered saturated.
+     * @param bitsPerItem Bits reserved per key; 10 gives roughly a 1% false positive rate.
+     */
+    explicit BloomFilter(qsizetype expectedItems = 1024, int bitsPerItem = 10);
+
+    /**
+     * @brief Add a key to the filter.
+     * @param key The key to insert.
+     */
+    void insert(QStringView key);
+
+    /**
+     * @brief Check whether a key may have been inserted.
+     * @param key The key to look up.
+     * @return False if the key was definitely never inserted, true otherwise.
+     */
+    bool mayContain(QStringView key) const;
+
+    /**
+     * @brief Remove all keys and resize the filter for a new expected number of keys.
+     * @param expectedItems Number of keys the filter should hold before it is considered saturated.
+     */
+    void reset(qsizetype expectedItems);
+
+    /**
+     * @brief Number of keys inserted since the last reset.
+     */
+    qsizetype size() const { return count; }
+
+    /**
+     * @brief Number of keys the filter was sized for.
+     */
+    qsizetype capacity() const { return expected; }
+
+    /**
+     * @brief Check whether more keys were inserted than the filter was sized for.
+     * @return True if the false positive rate is above the design target and the filter should be rebuilt.
+     */
+    bool isSaturated() const { return count > expected; }
+
+    /**
+     * @brief Write the filter to a file.
+     * @param path Destination file path.
+     * @param tag Caller-defined value stored with the filter, e.g. a fingerprint of the source data.
+     * @return True if the file was written, false otherwise.
+     */
+    bool save(const QString &path, quint64 tag) const;
+
+    /**
+     * @brief Replace the filter with one previously written by save().
+     * @param path Source file path.
+     * @param tag The tag that must match the stored one for the file to be accepted.
+     * @return True if the file was read and its tag matched, false otherwise (the filter is left unchanged).
+     */
+    bool load(const QString &path, quint64 tag);
+
+private:
+    static constexpr int wordsPerBlock = 8;  ///< 8 x 64 bits = one 512-bit block.
+    static constexpr int bitsPerKey = 8;     ///< Bits set in a block for each key.
+
+    /**
+     * @brief Map a key hash to its block.
+     * @param hash The stableKeyHash() of the key.
+     * @return Block index in the range 0 .. blockCount - 1.
+     */
+    qsizetype blockIndex(quint64 hash) const;
+
+    QList<quint64> words;    ///< Filter storage, wordsPerBlock words per block.
+    qsizetype blockCount = 0;
+    qsizetype expected = 0;
+    qsizetype count = 0;
+    int bitsPerItem = 10;
+};
+
+#endif // BLOOMFILTER_H
@@ -0,0 +1,61 @@
+#ifndef CACHEWARMER_H
+#define CACHEWARMER_H
+
+#include <QObject>
+#include <QStringList>
+
+class NetworkManager;
+
+/**
+ * @class CacheWarmer
+ * @brief Preloads the most looked-up addresses into the in-memory record cache after startup.
+ *
+ * The hottest addresses from the lookup history are read from the database a few at a time
+ * while the event loop is idle, so the first lookups after a restart hit memory. Hot
+ * addresses that are no longer stored, e.g. after the database was cleared, can be fetched
+ * from the API again within a fixed request budget.
+ */
+class CacheWarmer : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor for CacheWarmer.
+     * @param parent Optional parent QObject.
+     */
+    explicit CacheWarmer(QObject *parent = nullptr);
+
+    /**
+     * @brief Start warming up. Returns immediately; finished() is emitted when done.
+     * @param hotCount Number of hottest addresses to preload.
+     * @param budget Maximum number of API requests for hot addresses missing from the database; 0 disables prefetching.
+     */
+    void start(int hotCount, int apiBudget);
+
+signals:
+    /**
+     * @brief Signal emitted when the warm-up is complete.
+     * @param preloaded Number of records loaded from the database into memory.
+     * @param prefetched Number of records fetched from the API.
+     */
+    void finished(int preloaded, int prefetched);
+
+private:
+    /**
+     * @brief Preload the next slice of hot addresses, then yield to the event loop.
+     */
+    void preloadNext();
+
+    /**
+     * @brief Fetch hot addresses that are not stored, up to the API budget.
+     */
+    void prefetchMissing();
+
+    NetworkManager *networkManager; ///< Used for prefetching only.
+    QStringList pending;            ///< Hot addresses not yet preloaded.
+    QStringList missing;            ///< Hot addresses that are not in the database.
+    int apiBudget = 0;
+    int preloaded = 0;
+};
+
+#endif // CACHEWARMER_H
@@ -0,0 +1,60 @@
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <QList>
+
+#include <functional>
+#include <memory>
+
+/**
+ * @class CancellationToken
+ * @brief Shared flag that tells in-flight work to stop, and aborts it when set.
+ *
+ * Copies share the same state, so a token can be handed to every stage of a lookup and
+ * cancelled once by its owner. Stages register handlers that abort their DNS or HTTP work.
+ * Tokens are used from the GUI thread only and are not thread-safe.
+ */
+class CancellationToken {
+public:
+    /**
+     * @brief Cancel the work and run the registered handlers. Later calls do nothing.
+     */
+    void cancel() {
+        if (state->cancelled) {
+            return;
+        }
+        state->cancelled = true;
+        const QList<std::function<void()>> handlers = std::move(state->handlers);
+        state->handlers.clear();
+        for (const std::function<void()> &handler : handlers) {
+            handler();
+        }
+    }
+
+    /**
+     * @brief Check whether cancel() was called on this token or one of its copies.
+     */
+    bool isCancelled() const { return state->cancelled; }
+
+    /**
+     * @brief Register a handler that aborts work when the token is cancelled.
+     * @param handler Called once from cancel(), or immediately if the token is already cancelled.
+     */
+    void onCancel(std::function<void()> handler) {
+        if (state->cancelled) {
+            handler();
+        } else {
+            state->handlers.append(std::move(handler));
+        }
+    }
+
+private:
+    struct State {
+        bool cancelled = false;
+        QList<std::function<void()>> handlers;
+    };
+
+    std::shared_ptr<State> state = std::make_shared<State>();
+};
+
+#endif // CANCELLATIONTOKEN_H
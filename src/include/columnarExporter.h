@@ -0,0 +1,86 @@
+#ifndef COLUMNAREXPORTER_H
+#define COLUMNAREXPORTER_H
+
+#include <QObject>
+#include <QString>
+
+/**
+ * @class ColumnarExporter
+ * @brief Writes the address store to a compressed columnar file for analytics tools.
+ *
+ * Rows are streamed from the database and cut into row groups, so memory use is bounded by
+ * the row group size. Within a row group every column is stored contiguously and compressed
+ * on its own; columns are compressed in parallel. All integers are little-endian.
+ *
+ * File layout:
+ * - Header: "GCCF", u32 version (1), u32 column count, then per column a u8 type, a u16 name
+ *   length and the UTF-8 name.
+ * - Row groups: u32 row count, then per column a u32 byte length and the column data.
+ * - Dictionary: u32 entry count, u32 byte length and the data of a string column holding the
+ *   values that dictionary columns refer to, ID 0 first.
+ * - Footer: u64 dictionary offset, u64 total rows, u32 row group count, u64 offset per row
+ *   group, then u32 footer length (excluding these last 8 bytes) and "GCCF".
+ *
+ * Column data is compressed with qCompress(): a big-endian u32 uncompressed length followed by
+ * a zlib stream. Uncompressed, the column types are:
+ * - 1 address: 16 bytes per row, IPv6 in network order; IPv4 addresses are IPv4-mapped (::ffff:a.b.c.d).
+ * - 2 string: (rows + 1) u32 offsets into the UTF-8 bytes that follow.
+ * - 3 dictionary: u32 ID per row, indexing the dictionary section.
+ * - 4 float64: one IEEE 754 double per row; NaN when missing.
+ * - 5 int64: one signed integer per row.
+ */
+class ColumnarExporter : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @struct Summary
+     * @brief Outcome of an export run.
+     */
+    struct Summary {
+        bool ok = false;       ///< True if the file was written completely.
+        qint64 rows = 0;       ///< Rows written.
+        qint64 bytes = 0;      ///< Size of the file.
+        double seconds = 0;    ///< Wall-clock duration of the run.
+
+        double rowsPerSecond() const { return seconds > 0 ? rows / seconds : 0; }
+    };
+
+    /**
+     * @brief Constructor for ColumnarExporter.
+     * @param parent Optional parent QObject.
+     */
+    explicit ColumnarExporter(QObject *parent = nullptr);
+
+    /**
+     * @brief Export every stored record. Blocks until done.
+     * @param path Destination file path.
+     * @return Summary of the run.
+     */
+    Summary exportFile(const QString &path);
+
+    /**
+     * @brief Set the number of rows per row group.
+     * @param rows Rows buffered and compressed together.
+     */
+    void setRowGroupSize(int rows);
+
+signals:
+    /**
+     * @brief Signal emitted after each row group is written.
+     * @param rowsDone Rows written so far.
+     * @param rowsTotal Number of stored rows.
+     */
+    void progress(qint64 rowsDone, qint64 rowsTotal);
+
+    /**
+     * @brief Signal emitted for debug messages.
+     * @param message The debug message.
+     */
+    void debugMessage(const QString &message);
+
+private:
+    int rowGroupSize = 65536; ///< Rows per row group.
+};
+
+#endif // COLUMNAREXPORTER_H
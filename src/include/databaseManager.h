@@ -7,8 +7,30 @@
 #include <QSqlError>
 #include <QString>
 #include <QList>
+#include <QStringList>
 #include <QVariantMap>
 #include <QMutex>
+#include <QCache>
+
+#include <functional>
+
+#include "bloomFilter.h"
+
+/**
+ * @struct AddressRecord
+ * @brief One api_responses row in its stored form, with repeated fields as StringDictionary IDs.
+ */
+struct AddressRecord {
+    QString address;
+    QString hostname;
+    QString loc;
+    quint32 city = 0;
+    quint32 region = 0;
+    quint32 country = 0;
+    quint32 postal = 0;
+    quint32 timezone = 0;
+    qint64 changeSeq = 0; ///< Position in the change log, only filled in by getChangesSince() and forEachRecord().
+};
 
 /**
  * @class DatabaseManager
@@ -32,11 +54,57 @@ public:
     }
 
     /**
-     * @brief Initialize the database and create required tables if they do not exist.
+     * @brief Open the database and create required tables if they do not exist.
      * @return True if the database was successfully initialized, false otherwise.
+     *
+     * Only the first call does any work; a failure is reported through databaseError once and
+     * later calls return false straight away. Every other public method calls this on first
+     * use. Code that interns StringDictionary values must call it first, see StringDictionary::restore().
      */
     bool initializeDatabase();
 
+    /**
+     * @brief Choose where the database files live and how many shards hold the address data.
+     * @param directory Directory for the database files; created if missing.
+     * @param shards Requested number of address shards; 0 or 1 keeps everything in one file.
+     * @return True if the location was accepted, false if the database is already initialized or the directory cannot be created.
+     *
+     * The shard count is stored when a directory is first used and wins over later requests,
+     * because addresses are assigned to shards by hash. An existing single-file database with
+     * data keeps its layout.
+     */
+    bool setStorageLocation(const QString &directory, int shards);
+
+    /**
+     * @brief Get stored addresses added after a point in the change log.
+     * @param changeSeq Only records with a larger change sequence number are returned; 0 returns everything.
+     * @param limit Maximum number of records to return.
+     * @return Records ordered by change sequence number. Pass the last one's changeSeq to get the next page.
+     *
+     * Clearing the database is local and is not part of the change log.
+     */
+    QList<AddressRecord> getChangesSince(qint64 changeSeq, int limit);
+
+    /**
+     * @brief Stream every stored record, one shard at a time, without loading the table into memory.
+     * @param visit Called once per record; returning false stops the iteration.
+     * @return True if every record was visited, false on a database error or when visit stopped early.
+     */
+    bool forEachRecord(const std::function<bool(const AddressRecord &)> &visit);
+
+    /**
+     * @brief Add records exported by another instance, keeping local data for addresses already stored.
+     * @param records The records, with dictionary fields interned in this process's StringDictionary.
+     * @return Number of new addresses, or -1 on error. Merging the same records again returns 0.
+     */
+    qint64 mergeChanges(const QList<AddressRecord> &records);
+
+    /**
+     * @brief Reclaim free space by rewriting the database files one at a time.
+     * @return True if every file was compacted, false otherwise.
+     */
+    bool compactStorage();
+
     /**
      * @brief Check if a specific address exists in the database.
      * @param address The address to check.
@@ -82,6 +150,8 @@ public:
      * @brief Retrieve specific address data from the database.
      * @param address The address to look up.
      * @return A QVariantMap containing data associated with the address.
+     *
+     * Recently read records are served from an in-memory LRU cache.
      */
     QVariantMap getSpecificAddressData(const QString &address);
 
@@ -90,6 +160,77 @@ public:
      */
     void logTables();
 
+    /**
+     * @brief Get the number of stored addresses per value of a field.
+     * @param dimension One of "country", "region" or "timezone".
+     * @return A list of maps with "value" and "count" keys, largest groups first.
+     *
+     * Counts are maintained incrementally, so the cost depends on the number of groups, not rows.
+     */
+    QVariantList getGroupCounts(const QString &dimension);
+
+    /**
+     * @brief Get the number of stored addresses from the aggregate statistics.
+     * @return The total number of rows in api_responses.
+     */
+    qint64 getAddressCount();
+
+    /**
+     * @brief Count one lookup in the current hourly bucket.
+     */
+    void recordLookup();
+
+    /**
+     * @brief Count a lookup of a specific address in the lookup history.
+     * @param address The address whose data was shown.
+     */
+    void recordAddressLookup(const QString &address);
+
+    /**
+     * @brief Get the addresses looked up most, favouring recent lookups.
+     * @param limit Maximum number of addresses to return.
+     * @return The addresses, hottest first. They are not necessarily still stored.
+     */
+    QStringList getHotAddresses(int limit);
+
+    /**
+     * @brief Get the lookup volume per hour.
+     * @param hours How many hours back to report, including the current one.
+     * @return A list of maps with "time" and "lookups" keys, oldest first. Hours without lookups are omitted.
+     */
+    QVariantList getLookupVolume(int hours);
+
+    /**
+     * @brief Prepare the staging tables for a bulk import and find where a previous run stopped.
+     * @param source Identifier of the input, e.g. its path, size and modification time.
+     * @return Byte offset in the input up to which rows are already staged, 0 for a new import, or -1 on error.
+     *
+     * Rows staged for a different source are discarded.
+     */
+    qint64 beginImport(const QString &source);
+
+    /**
+     * @brief Stage a batch of imported records and record the input offset they end at, in one transaction.
+     * @param source Identifier passed to beginImport().
+     * @param records The records to stage.
+     * @param endOffset Byte offset in the input just past the last staged row.
+     * @return True if the batch was committed, false otherwise.
+     */
+    bool stageImportBatch(const QString &source, const QList<AddressRecord> &records, qint64 endOffset);
+
+    /**
+     * @brief Merge all staged records into api_responses and clear the import state.
+     * @return Number of new addresses added, or -1 on error. Addresses that already exist are kept unchanged.
+     */
+    qint64 finishImport();
+
+signals:
+    /**
+     * @brief Signal emitted when the database cannot be initialized.
+     * @param error The error message.
+     */
+    void databaseError(const QString &error);
+
 private:
     /**
      * @brief Private constructor for the singleton pattern.
@@ -104,6 +245,208 @@ private:
 
     QSqlDatabase db; ///< The QSqlDatabase instance for managing database connections.
     QMutex dbMutex;  ///< Mutex for ensuring thread safety in database operations.
+    QString storageDirectory;        ///< Directory holding the database file and any shard files.
+    QString databasePath;            ///< Path of the SQLite database file.
+    int requestedShardCount = 0;     ///< Shard count passed to setStorageLocation(), used for new storage only.
+    QStringList shardConnectionNames; ///< Connection name per address shard, empty for the single-file layout.
+    qint64 lastChangeSeq = 0;        ///< Highest change sequence number handed out, mirrored in storage_settings.
+    QCache<QString, QVariantMap> recordCache{1024}; ///< Decoded records of recently read addresses.
+    bool initialized = false;        ///< True once initializeDatabase() has succeeded.
+    bool initializationFailed = false; ///< True once initializeDatabase() has failed; it is not retried.
+    BloomFilter addressFilter;       ///< In-memory filter of all stored addresses for fast negative lookups.
+    bool addressFilterReady = false; ///< True once addressFilter reflects every row in api_responses.
+    bool dictionaryLoaded = false;          ///< True once the stored string dictionary has been loaded.
+    qsizetype persistedDictionarySize = 0;  ///< Number of StringDictionary entries already in string_dictionary.
+
+    /**
+     * @brief Build the CREATE TABLE statement for the address table.
+     * @param tableName Name of the table to create.
+     * @return The SQL statement.
+     */
+    static QString responsesTableSql(const QString &tableName);
+
+    /**
+     * @brief Create or upgrade api_responses and its statistics tables in one database file.
+     * @param db The main database or one of the shards.
+     * @param allowMigration True to convert a version 0 api_responses table, only done for the main database.
+     * @return True on success, false otherwise.
+     */
+    bool prepareAddressTables(QSqlDatabase db, bool allowMigration);
+
+    /**
+     * @brief Create the aggregate statistics tables and the triggers that maintain them.
+     * @param db The database holding api_responses.
+     * @param backfill True to recompute the counts from api_responses, for databases that predate them.
+     * @return True on success, false otherwise.
+     */
+    bool createStatisticsTables(QSqlDatabase db, bool backfill);
+
+    /**
+     * @brief Record the schema version of a database file in PRAGMA user_version.
+     * @param db The database to update.
+     * @param version The version that is now fully applied.
+     * @return True if the version was written, false otherwise.
+     */
+    static bool setSchemaVersion(QSqlDatabase db, int version);
+
+    /**
+     * @brief Add and number the change_seq column for an api_responses table that predates it.
+     * @param db The database holding api_responses.
+     * @return True on success, false otherwise.
+     */
+    bool addChangeSequenceColumn(QSqlDatabase db);
+
+    /**
+     * @brief Hand out a block of consecutive change sequence numbers.
+     * @param count Number of sequence numbers needed.
+     * @return The first number of the block, or -1 if the new high-water mark could not be stored.
+     */
+    qint64 reserveChangeSequence(qint64 count);
+
+    /**
+     * @brief Read the stored shard count, or store the requested one for new storage.
+     * @return The number of address shards, or 0 on error.
+     */
+    int resolveShardCount();
+
+    /**
+     * @brief Get the file path of a shard.
+     * @param shard Shard index.
+     * @return Path of the shard file inside the storage directory.
+     */
+    QString shardFilePath(int shard) const;
+
+    /**
+     * @brief Open the shard files and prepare their tables.
+     * @param shards Number of shards.
+     * @return True if every shard is ready, false otherwise.
+     */
+    bool openShards(int shards);
+
+    /**
+     * @brief Get the shard an address is stored in.
+     * @param address The address.
+     * @return Index into shardConnectionNames. Only valid for the sharded layout.
+     */
+    int shardIndex(const QString &address) const;
+
+    /**
+     * @brief Get the database holding a specific address.
+     * @param address The address.
+     * @return The shard for the address, or the main database for the single-file layout.
+     */
+    QSqlDatabase addressDatabase(const QString &address) const;
+
+    /**
+     * @brief Get every database holding api_responses rows.
+     * @return The shards in order, or just the main database for the single-file layout.
+     */
+    QList<QSqlDatabase> addressDatabases() const;
+
+    /**
+     * @brief Get the file paths of every database holding api_responses rows.
+     *
+     * Derived from the storage layout rather than the open connections, so it stays valid
+     * after the connections are removed.
+     * @return The shard files in order, or just the main database file for the single-file layout.
+     */
+    QStringList addressDatabaseFiles() const;
+
+    /**
+     * @brief Run a task per shard on the thread pool, each with its own connection.
+     * @param work Called with a connection to the shard and its index; returns false on failure.
+     * @return True if every task succeeded, false otherwise.
+     */
+    bool forEachShardInParallel(const std::function<bool(QSqlDatabase &, int)> &work);
+
+    /**
+     * @brief Insert records into an address table without checking for duplicates.
+     * @param db The database holding the table.
+     * @param table Either api_responses or import_staging.
+     * @param records The records to insert.
+     * @return True if every record was inserted, false otherwise.
+     */
+    static bool insertRecords(QSqlDatabase &db, const QString &table, const QList<AddressRecord> &records);
+
+    /**
+     * @brief Move staged import rows into api_responses in one transaction.
+     * @param addressDb The database holding both tables.
+     * @param firstChangeSeq First of the change sequence numbers reserved for the staged rows.
+     * @return Number of new addresses, or -1 on error.
+     */
+    static qint64 mergeStagedRecords(QSqlDatabase &addressDb, qint64 firstChangeSeq);
+
+    /**
+     * @brief Load the string_dictionary table into the process-wide StringDictionary.
+     * @return True if the dictionary was loaded, false otherwise.
+     */
+    bool loadDictionary();
+
+    /**
+     * @brief Store pending StringDictionary entries in a transaction of their own.
+     *
+     * Must be called before rows that refer to new entries are written, and outside of any open
+     * transaction on the main database.
+     * @return True if all pending entries were committed, false otherwise.
+     */
+    bool persistDictionary();
+
+    /**
+     * @brief Write StringDictionary entries that are not yet stored within the caller's transaction.
+     *
+     * persistedDictionarySize is left untouched; the caller passes writtenSize to
+     * confirmDictionary() after its commit. After a rollback nothing needs undoing, the
+     * entries are written again by the next call.
+     * @param writtenSize Set to the dictionary size covered by the written rows.
+     * @return True if all pending entries were written, false otherwise.
+     */
+    bool writeDictionary(qsizetype &writtenSize);
+
+    /**
+     * @brief Record that dictionary rows written by writeDictionary() have been committed.
+     * @param writtenSize The size reported by writeDictionary().
+     */
+    void confirmDictionary(qsizetype writtenSize);
+
+    /**
+     * @brief Convert a version 0 api_responses table with TEXT fields to dictionary IDs.
+     * @return True if the migration was committed, false otherwise.
+     */
+    bool migrateToDictionarySchema();
+
+    /**
+     * @brief Open the database files, load the dictionary and prepare every table.
+     * @return True on success, false otherwise (databaseError has been emitted).
+     */
+    bool openStorage();
+
+    /**
+     * @brief Run initializeDatabase() unless it already succeeded.
+     * @return True if the database is ready for use.
+     */
+    bool ensureInitialized() { return initialized || initializeDatabase(); }
+
+    /**
+     * @brief Populate the address filter from the sidecar file, or rebuild it from the database if the sidecar is missing or stale.
+     */
+    void loadAddressFilter();
+
+    /**
+     * @brief Rebuild the address filter by reading every stored address.
+     * @return True if the filter was rebuilt, false if the database could not be read.
+     */
+    bool rebuildAddressFilter();
+
+    /**
+     * @brief Write the address filter to its sidecar file next to the database.
+     */
+    void saveAddressFilter();
+
+    /**
+     * @brief Compute a fingerprint of the address database files used to detect a stale sidecar filter.
+     * @return A value derived from the size and modification time of each file, or 0 if one is missing.
+     */
+    quint64 databaseFingerprint() const;
 
     /**
      * @brief Check if a specific table exists in the database.
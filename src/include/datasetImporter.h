@@ -0,0 +1,78 @@
+#ifndef DATASETIMPORTER_H
+#define DATASETIMPORTER_H
+
+#include <QObject>
+#include <QString>
+
+/**
+ * @class DatasetImporter
+ * @brief Seeds the offline store from large CSV or JSONL geolocation datasets.
+ *
+ * The input file is memory-mapped and cut into chunks at line boundaries. Chunks are parsed
+ * in parallel on the global thread pool and the resulting rows are staged through
+ * DatabaseManager in large transactions. The address index is only updated once, when the
+ * staged rows are merged at the end. Progress is committed with every batch, so an
+ * interrupted import of the same file resumes where it stopped.
+ *
+ * CSV files need a header row naming the columns (ip or address, hostname, city, region,
+ * country, loc or lat/lon, postal, timezone). Files ending in .jsonl or .ndjson are read as
+ * one ipinfo-style JSON object per line.
+ */
+class DatasetImporter : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @struct Summary
+     * @brief Outcome of an import run.
+     */
+    struct Summary {
+        bool ok = false;          ///< True if the import completed and was merged.
+        bool resumed = false;     ///< True if the run continued an interrupted import.
+        qint64 parsedRows = 0;    ///< Rows parsed in this run.
+        qint64 skippedRows = 0;   ///< Rows rejected because they had no valid IPv4 or IPv6 address.
+        qint64 insertedRows = 0;  ///< New addresses added to the store.
+        double seconds = 0;       ///< Wall-clock duration of the run.
+
+        double rowsPerSecond() const { return seconds > 0 ? parsedRows / seconds : 0; }
+    };
+
+    /**
+     * @brief Constructor for DatasetImporter.
+     * @param parent Optional parent QObject.
+     */
+    explicit DatasetImporter(QObject *parent = nullptr);
+
+    /**
+     * @brief Import a dataset file into the address store. Blocks until done.
+     * @param path Path of the CSV or JSONL file.
+     * @return Summary of the run.
+     */
+    Summary importFile(const QString &path);
+
+    /**
+     * @brief Set the size of the chunks handed to parser threads.
+     * @param bytes Approximate chunk size in bytes.
+     */
+    void setChunkSize(qint64 bytes);
+
+signals:
+    /**
+     * @brief Signal emitted after each committed batch.
+     * @param bytesDone Bytes of the input processed so far.
+     * @param bytesTotal Total size of the input.
+     * @param rowsPerSecond Parse and stage rate of this run so far.
+     */
+    void progress(qint64 bytesDone, qint64 bytesTotal, double rowsPerSecond);
+
+    /**
+     * @brief Signal emitted for debug messages.
+     * @param message The debug message.
+     */
+    void debugMessage(const QString &message);
+
+private:
+    qint64 chunkSize = 4 * 1024 * 1024; ///< Bytes per parser task.
+};
+
+#endif // DATASETIMPORTER_H
@@ -0,0 +1,53 @@
+#ifndef DELTASYNC_H
+#define DELTASYNC_H
+
+#include <QObject>
+#include <QString>
+
+/**
+ * @class DeltaSync
+ * @brief Exports and merges the addresses added to the store since a point in its change log.
+ *
+ * Every stored address carries a change sequence number. An export writes the records after a
+ * given number to a compact file, so instances can share lookups without copying whole
+ * database files. The file is a small header followed by zlib-compressed blocks of JSONL, one
+ * ipinfo-style object per line with the dictionary fields spelled out, so it does not depend
+ * on the exporting instance's string IDs.
+ *
+ * Merging keeps the local data for addresses that are already stored, so importing the same
+ * file twice, or overlapping exports, is safe.
+ */
+class DeltaSync : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor for DeltaSync.
+     * @param parent Optional parent QObject.
+     */
+    explicit DeltaSync(QObject *parent = nullptr);
+
+    /**
+     * @brief Write the records added after a change sequence number to a file.
+     * @param path Destination file path.
+     * @param sinceChangeSeq Only records after this number are exported; 0 exports everything.
+     * @return The last exported change sequence number, to pass as sinceChangeSeq next time, or -1 on error.
+     */
+    qint64 exportChanges(const QString &path, qint64 sinceChangeSeq);
+
+    /**
+     * @brief Merge a file written by exportChanges() into the store.
+     * @param path Source file path.
+     * @return Number of new addresses, or -1 if the file could not be read or merged.
+     */
+    qint64 importChanges(const QString &path);
+
+signals:
+    /**
+     * @brief Signal emitted for debug messages.
+     * @param message The debug message.
+     */
+    void debugMessage(const QString &message);
+};
+
+#endif // DELTASYNC_H
@@ -0,0 +1,88 @@
+#ifndef IPSCANNER_H
+#define IPSCANNER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QtGlobal>
+
+/**
+ * @class IpScanner
+ * @brief Finds and parses dotted-quad IPv4 addresses in raw UTF-8 byte buffers.
+ *
+ * The scanner works directly on bytes and never builds QString objects. Candidate
+ * runs of digits and dots are located with SSE4.2 or AVX2 when the CPU supports it,
+ * falling back to a scalar loop otherwise. The implementation is selected once at runtime.
+ *
+ * A run is reported as an address when it splits into exactly four non-empty parts,
+ * each with a numeric value between 0 and 255, which matches Validator::isValidIpAddress.
+ */
+class IpScanner {
+public:
+    /**
+     * @brief Instruction set used to locate candidate runs.
+     */
+    enum class Isa {
+        Auto,   ///< Best implementation supported by the running CPU.
+        Scalar, ///< Portable byte-by-byte loop.
+        Sse42,  ///< SSE4.2 PCMPESTRM range matching, 16 bytes per step.
+        Avx2    ///< AVX2 byte compares, 32 bytes per step.
+    };
+
+    /**
+     * @struct Match
+     * @brief A single address found in the input buffer.
+     */
+    struct Match {
+        qsizetype offset = 0; ///< Byte offset of the first character of the address.
+        qsizetype length = 0; ///< Length of the address text in bytes.
+        quint32 address = 0;  ///< The address in host byte order (a.b.c.d -> 0xaabbccdd).
+    };
+
+    /**
+     * @brief Scan a buffer for IPv4 addresses.
+     * @param data Pointer to the UTF-8 bytes to scan.
+     * @param size Number of bytes in the buffer.
+     * @param isa Instruction set to use; Auto picks the fastest supported one.
+     * @return All addresses found, in order of appearance.
+     */
+    static QList<Match> scan(const char *data, qsizetype size, Isa isa = Isa::Auto);
+
+    /**
+     * @brief Convenience overload scanning a QByteArray.
+     * @param data The UTF-8 bytes to scan.
+     * @param isa Instruction set to use; Auto picks the fastest supported one.
+     * @return All addresses found, in order of appearance.
+     */
+    static QList<Match> scan(const QByteArray &data, Isa isa = Isa::Auto);
+
+    /**
+     * @brief Parse a complete run of digits and dots as an IPv4 address.
+     * @param data Pointer to the first byte of the run.
+     * @param size Length of the run in bytes.
+     * @param address Receives the parsed address on success; may be nullptr.
+     * @return True if the run is a valid dotted-quad address, false otherwise.
+     */
+    static bool parseIpv4(const char *data, qsizetype size, quint32 *address = nullptr);
+
+    /**
+     * @brief Check whether the running CPU supports the given instruction set.
+     * @param isa The instruction set to query.
+     * @return True if scan() can use it on this machine.
+     */
+    static bool isSupported(Isa isa);
+
+    /**
+     * @brief Resolve Isa::Auto to the implementation chosen for this machine.
+     * @return The instruction set used when Isa::Auto is requested.
+     */
+    static Isa bestIsa();
+
+    /**
+     * @brief Format an address as dotted-quad text.
+     * @param address The address in host byte order.
+     * @return The textual representation, e.g. "192.168.0.1".
+     */
+    static QByteArray toByteArray(quint32 address);
+};
+
+#endif // IPSCANNER_H
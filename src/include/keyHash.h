@@ -0,0 +1,30 @@
+#ifndef KEYHASH_H
+#define KEYHASH_H
+
+#include <QChar>
+#include <QStringView>
+#include <QtGlobal>
+
+/**
+ * @brief Hash an address key with a function that is stable across runs, platforms and Qt versions.
+ *
+ * Used wherever a hash ends up on disk, such as the Bloom filter sidecar and shard routing,
+ * so it must never change. FNV-1a over UTF-16 code units followed by the splitmix64 finalizer.
+ * @param key The key to hash.
+ * @return A 64-bit hash of the key.
+ */
+inline quint64 stableKeyHash(QStringView key) {
+    quint64 hash = 0xcbf29ce484222325ull;
+    for (QChar c : key) {
+        hash ^= c.unicode();
+        hash *= 0x100000001b3ull;
+    }
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebull;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+#endif // KEYHASH_H
@@ -0,0 +1,38 @@
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <QLoggingCategory>
+
+/**
+ * @file logging.h
+ * @brief Logging categories used across GeoCatch.
+ *
+ * Every component logs through its own QLoggingCategory. The qCDebug/qCInfo/qCWarning macros
+ * test whether the level is enabled before evaluating any of the streamed arguments, so a
+ * disabled message costs one branch and no formatting or allocation.
+ *
+ * Debug output is on by default in debug builds and off in release builds. It can be changed
+ * at runtime with QT_LOGGING_RULES, e.g. "geocatch.database.debug=true".
+ */
+
+Q_DECLARE_LOGGING_CATEGORY(lcDatabase)  ///< geocatch.database
+Q_DECLARE_LOGGING_CATEGORY(lcNetwork)   ///< geocatch.network
+Q_DECLARE_LOGGING_CATEGORY(lcValidator) ///< geocatch.validator
+Q_DECLARE_LOGGING_CATEGORY(lcImport)    ///< geocatch.import
+Q_DECLARE_LOGGING_CATEGORY(lcStartup)   ///< geocatch.startup
+Q_DECLARE_LOGGING_CATEGORY(lcTrace)     ///< geocatch.trace, feeds TraceBuffer; off unless enabled by a rule
+
+/**
+ * @brief Emit the debugMessage signal of the current object, only if debug output is enabled for the category.
+ *
+ * The message expression is not evaluated when the category is disabled. Use inside member
+ * functions of classes that declare a debugMessage(const QString &) signal.
+ */
+#define GEOCATCH_DEBUG_MESSAGE(category, message) \
+    do { \
+        if (Q_UNLIKELY(category().isDebugEnabled())) { \
+            emit debugMessage(message); \
+        } \
+    } while (false)
+
+#endif // LOGGING_H
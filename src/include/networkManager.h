@@ -2,10 +2,19 @@
 #define NETWORKMANAGER_H
 
 #include <QObject>
+#include <QFuture>
+#include <QVariantMap>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QString>
 #include <QTimer>
+#include <QUrl>
+
+#include <QHash>
+
+#include <memory>
+
+#include "cancellationToken.h"
 
 /**
  * @class NetworkManager
@@ -18,6 +27,22 @@ class NetworkManager : public QObject {
     Q_OBJECT
 
 public:
+    /**
+     * @struct Endpoints
+     * @brief Service URLs used by a NetworkManager.
+     */
+    struct Endpoints {
+        QUrl api = QUrl("https://ipinfo.io/");                           ///< Geolocation API, queried as <api><ip>/json.
+        QUrl publicIp = QUrl("https://api.ipify.org?format=json");        ///< Returns the caller's public IP as {"ip": ...}.
+        QUrl connectionCheck = QUrl("https://www.google.com");            ///< Probed with HEAD to detect connectivity.
+    };
+
+    /**
+     * @brief Set the endpoints used by NetworkManager instances created afterwards.
+     * @param endpoints The service URLs, e.g. a local mock server in tests.
+     */
+    static void setDefaultEndpoints(const Endpoints &endpoints);
+
     /**
      * @brief Constructor for NetworkManager.
      * @param parent Optional parent QObject.
@@ -25,15 +50,35 @@ public:
     explicit NetworkManager(QObject *parent = nullptr);
 
     /**
-     * @brief Make an API call to fetch data for a given IP address.
+     * @brief Fetch geolocation data for an IP address from the API.
+     * @param ip The IP address to query.
+     * @param token Aborts the request when cancelled.
+     * @return A future with the parsed fields and "address" set to ip, or an empty map on failure or cancellation.
+     *
+     * Nothing is stored or emitted; callers chain those steps onto the future.
+     */
+    QFuture<QVariantMap> fetchAddressData(const QString &ip, CancellationToken token = {});
+
+    /**
+     * @brief Fetch geolocation data, sharing one request among concurrent callers for the same IP.
+     * @param ip The IP address to query.
+     * @param token Releases this caller; the request is aborted once every caller has cancelled.
+     * @return A future with the same result as fetchAddressData().
+     */
+    QFuture<QVariantMap> fetchAddressDataCoalesced(const QString &ip, CancellationToken token = {});
+
+    /**
+     * @brief Make an API call for a given IP address, store the result and emit apiResponseReceived().
      * @param ip The IP address to query.
      */
     void makeApiCall(const QString &ip);
 
     /**
      * @brief Resolve the localhost address to the public IP.
+     * @param token Aborts the request when cancelled.
+     * @return A future with the public IP, or an empty string on failure or cancellation.
      */
-    void resolveLocalhost();
+    QFuture<QString> fetchPublicIp(CancellationToken token = {});
 
     /**
      * @brief Check if the network is currently online.
@@ -55,10 +100,20 @@ public:
     Q_INVOKABLE void checkConnectionStatus();
 
 private:
+    static Endpoints &defaultEndpoints();
+
+    Endpoints endpoints;                   ///< Service URLs, copied from the defaults at construction.
     QNetworkAccessManager *networkManager; ///< Manages network requests.
     QTimer *connectionTimer;               ///< Timer for periodically checking connection status.
     bool online = true;                    ///< Stores the current online status.
 
+    struct PendingFetch {
+        QFuture<QVariantMap> future; ///< Result shared by every caller.
+        CancellationToken token;     ///< Aborts the request once no caller is waiting.
+        int waiters = 0;             ///< Callers that have not cancelled.
+    };
+    QHash<QString, std::shared_ptr<PendingFetch>> pendingFetches; ///< In-flight API requests by IP.
+
 signals:
     /**
      * @brief Signal emitted when an API response is received.
@@ -87,12 +142,6 @@ signals:
      */
     void connectionStatusChanged(bool isOnline);
 
-    /**
-     * @brief Signal emitted when the localhost is resolved to a public IP.
-     * @param publicIP The resolved public IP address.
-     */
-    void localhostResolved(const QString &publicIP);
-
 private slots:
     /**
      * @brief Handle the response from a connection status check.
@@ -0,0 +1,49 @@
+#ifndef STARTUPTIMELINE_H
+#define STARTUPTIMELINE_H
+
+#include <QList>
+#include <QtGlobal>
+
+/**
+ * @class StartupTimeline
+ * @brief Records named milestones during application startup.
+ *
+ * Times are measured from the first call to mark(), which main() makes before anything else.
+ * The timeline is written to the geocatch.startup logging category.
+ */
+class StartupTimeline {
+public:
+    /**
+     * @struct Mark
+     * @brief A single milestone.
+     */
+    struct Mark {
+        const char *name = nullptr; ///< Static milestone name.
+        qint64 elapsedNs = 0;       ///< Time since the first mark in nanoseconds.
+    };
+
+    /**
+     * @brief Record a milestone.
+     * @param name Milestone name; must point to a string with static storage duration.
+     */
+    static void mark(const char *name);
+
+    /**
+     * @brief Get the recorded milestones in order.
+     * @return The milestones.
+     */
+    static QList<Mark> marks();
+
+    /**
+     * @brief Get the time since the first mark.
+     * @return Elapsed time in milliseconds.
+     */
+    static double elapsedMs();
+
+    /**
+     * @brief Write the timeline to the geocatch.startup category at info level.
+     */
+    static void dump();
+};
+
+#endif // STARTUPTIMELINE_H
@@ -0,0 +1,87 @@
+#ifndef STRINGDICTIONARY_H
+#define STRINGDICTIONARY_H
+
+#include <QHash>
+#include <QList>
+#include <QReadWriteLock>
+#include <QString>
+
+/**
+ * @class StringDictionary
+ * @brief Process-wide intern table for geolocation fields that repeat across records.
+ *
+ * Values such as country, region, city, timezone and postal code are stored once and referred
+ * to by a dense integer ID. intern() returns a QString that shares its data with the pooled copy,
+ * so records built from interned values do not carry their own string buffers.
+ *
+ * IDs are assigned in insertion order starting at 0 and are the same IDs used in the
+ * string_dictionary table on disk, see DatabaseManager.
+ */
+class StringDictionary {
+public:
+    /**
+     * @brief Get the singleton instance of StringDictionary.
+     * @return Reference to the single StringDictionary instance.
+     */
+    static StringDictionary& instance() {
+        static StringDictionary instance;
+        return instance;
+    }
+
+    /**
+     * @brief Get the ID of a value, adding it to the dictionary if needed.
+     * @param value The value to intern.
+     * @return The ID of the value.
+     */
+    quint32 idFor(const QString &value);
+
+    /**
+     * @brief Get the shared copy of a value, adding it to the dictionary if needed.
+     * @param value The value to intern.
+     * @return A QString sharing its data with the pooled copy.
+     */
+    QString intern(const QString &value);
+
+    /**
+     * @brief Look up a value by ID.
+     * @param id The ID returned by idFor().
+     * @return The shared copy of the value, or a null QString if the ID is unknown.
+     */
+    QString value(quint32 id) const;
+
+    /**
+     * @brief Number of distinct values in the dictionary.
+     */
+    qsizetype size() const;
+
+    /**
+     * @brief Get the values whose IDs are at or above the given ID, in ID order.
+     * @param firstId The first ID to return.
+     * @return The values for IDs firstId .. size() - 1.
+     */
+    QList<QString> valuesFrom(quint32 firstId) const;
+
+    /**
+     * @brief Populate an empty dictionary with values loaded from storage.
+     *
+     * Must run before anything is interned, otherwise IDs already handed out would clash with
+     * the stored ones. DatabaseManager::initializeDatabase() calls it, and every interning path
+     * opens storage first.
+     * @param values The values in ID order.
+     * @return True if the dictionary was empty and has been populated, false otherwise.
+     */
+    bool restore(const QList<QString> &values);
+
+private:
+    StringDictionary() = default;
+
+    mutable QReadWriteLock lock; ///< Guards ids and values; lookups take the read lock.
+    QHash<QString, quint32> ids; ///< Value to ID.
+    QList<QString> values;       ///< ID to value; the pooled copies.
+
+    // Disable copying
+    StringDictionary(const StringDictionary&) = delete;
+    StringDictionary& operator=(const StringDictionary&) = delete;
+};
+
+#endif // STRINGDICTIONARY_H
@@ -0,0 +1,92 @@
+#ifndef TRACEBUFFER_H
+#define TRACEBUFFER_H
+
+#include <QList>
+#include <QtGlobal>
+
+#include <atomic>
+#include <memory>
+
+#include "logging.h"
+
+/**
+ * @class TraceBuffer
+ * @brief Lock-free ring buffer of hot-path trace events.
+ *
+ * Events are a static string plus two integers, so recording one never formats or allocates.
+ * Any number of threads can record concurrently; when the buffer is full the oldest events are
+ * overwritten. Recording is gated by the geocatch.trace category, see GEOCATCH_TRACE.
+ */
+class TraceBuffer {
+public:
+    /**
+     * @struct Event
+     * @brief A single recorded trace event.
+     */
+    struct Event {
+        qint64 timestampNs = 0;    ///< Monotonic time of the event in nanoseconds.
+        const char *name = nullptr; ///< Static event name.
+        qint64 a = 0;              ///< First event argument.
+        qint64 b = 0;              ///< Second event argument.
+    };
+
+    /**
+     * @brief Get the singleton instance of TraceBuffer.
+     * @return Reference to the single TraceBuffer instance.
+     */
+    static TraceBuffer& instance() {
+        static TraceBuffer instance;
+        return instance;
+    }
+
+    /**
+     * @brief Record an event. Wait-free.
+     * @param name Event name; must point to a string with static storage duration.
+     * @param a First event argument.
+     * @param b Second event argument.
+     */
+    void record(const char *name, qint64 a = 0, qint64 b = 0);
+
+    /**
+     * @brief Copy the events currently in the buffer, oldest first.
+     * @return The events. Slots being written during the call are skipped.
+     */
+    QList<Event> snapshot() const;
+
+    /**
+     * @brief Write the buffered events to the geocatch.trace category at info level.
+     */
+    void dump() const;
+
+private:
+    static constexpr quint64 capacity = 1 << 16; ///< Number of slots; a power of two.
+
+    struct Slot {
+        std::atomic<quint64> sequence{0}; ///< Odd while being written, 2 * (index + 1) once complete.
+        std::atomic<qint64> timestampNs{0};
+        std::atomic<const char *> name{nullptr};
+        std::atomic<qint64> a{0};
+        std::atomic<qint64> b{0};
+    };
+
+    TraceBuffer();
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<quint64> writeIndex{0};
+
+    // Disable copying
+    TraceBuffer(const TraceBuffer&) = delete;
+    TraceBuffer& operator=(const TraceBuffer&) = delete;
+};
+
+/**
+ * @brief Record a trace event if geocatch.trace debug output is enabled. Costs one branch otherwise.
+ */
+#define GEOCATCH_TRACE(name, a, b) \
+    do { \
+        if (Q_UNLIKELY(lcTrace().isDebugEnabled())) { \
+            TraceBuffer::instance().record(name, (a), (b)); \
+        } \
+    } while (false)
+
+#endif // TRACEBUFFER_H
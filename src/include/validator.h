@@ -2,10 +2,14 @@
 #define VALIDATOR_H
 
 #include <QObject>
+#include <QFuture>
 #include <QString>
 #include <QUrl>
+#include <QVariantList>
+#include <QHostAddress>
 
 #include "networkManager.h"
+#include "cancellationToken.h"
 
 /**
  * @class Validator
@@ -17,6 +21,11 @@
 class Validator : public QObject {
     Q_OBJECT
 
+    /**
+     * @brief When true, URL lookups resolve every A and AAAA record of the host and look them all up.
+     */
+    Q_PROPERTY(bool resolveAllAddresses READ resolveAllAddresses WRITE setResolveAllAddresses NOTIFY resolveAllAddressesChanged)
+
 public:
     /**
      * @brief Constructor for Validator.
@@ -24,11 +33,17 @@ public:
      */
     explicit Validator(QObject *parent = nullptr);
 
+    bool resolveAllAddresses() const;
+    void setResolveAllAddresses(bool enabled);
+
     /**
      * @brief Validate the given input as an IP address or URL.
      * @param input The input string to validate.
      *
      * This function determines if the input is a valid IP address or URL, and processes it accordingly.
+     * The lookup runs as a chain of future continuations (resolve, fetch and store, publish)
+     * owned by this call, and requestFinished() is emitted when the chain completes. Calling it
+     * again cancels the previous lookup, so only the latest input produces a result.
      */
     Q_INVOKABLE void validateInput(const QString &input);
 
@@ -50,8 +65,47 @@ public:
      */
     Q_INVOKABLE void copyToClipboard(const QString &text);
 
+    /**
+     * @brief Get the number of stored addresses per country, region or timezone.
+     * @param dimension One of "country", "region" or "timezone".
+     * @return A list of maps with "value" and "count" keys, largest groups first.
+     */
+    Q_INVOKABLE QVariantList statistics(const QString &dimension);
+
+    /**
+     * @brief Get the number of lookups per hour.
+     * @param hours How many hours back to report.
+     * @return A list of maps with "time" and "lookups" keys, oldest first.
+     */
+    Q_INVOKABLE QVariantList lookupVolume(int hours);
+
+    /**
+     * @brief Get the number of addresses stored in the database.
+     * @return The number of stored addresses.
+     */
+    Q_INVOKABLE qint64 storedAddressCount();
+
+    /**
+     * @brief Extract all IPv4 addresses found in a block of text.
+     * @param text The text to scan, e.g. pasted log lines.
+     * @return The addresses in order of appearance, formatted as dotted quads.
+     */
+    Q_INVOKABLE QList<QString> extractIpAddresses(const QString &text);
+
 private:
+    /**
+     * @brief Kind of input accepted by validateInput().
+     */
+    enum class InputKind {
+        Localhost, ///< "localhost", looked up by its public IP.
+        IpAddress, ///< A dotted-quad IPv4 address.
+        Url,       ///< A URL or bare host name.
+        Invalid    ///< Anything else.
+    };
+
     NetworkManager *networkManager; ///< Pointer to the NetworkManager for online API calls.
+    CancellationToken activeLookup;  ///< Token of the latest lookup, cancelled when a new one starts.
+    bool resolveAll = false;         ///< Backing field of the resolveAllAddresses property.
 
     /**
      * @brief Check if the given string is a valid IP address.
@@ -75,15 +129,57 @@ private:
     QString normalizeUrl(const QString &input);
 
     /**
-     * @brief Handle special case for resolving "localhost".
+     * @brief Resolve stage: turn the validated input into the address to look up.
+     * @param kind The kind of input.
+     * @param target The IP address, or the host name for URLs.
+     * @param online True if the API and DNS can be used.
+     * @param token Aborts the DNS or HTTP request when cancelled.
+     * @return A future with the address, or an empty string if it could not be resolved.
      */
-    void handleLocalhost();
+    QFuture<QString> resolveTarget(InputKind kind, const QString &target, bool online, CancellationToken token);
 
     /**
-     * @brief Query the database for information related to the given input.
-     * @param input The input string to query.
+     * @brief Resolve all A and AAAA records of a host.
+     * @param host The host name.
+     * @param token Aborts the DNS lookup when cancelled.
+     * @return A future with the addresses, or an empty list on error.
      */
-    void queryDatabase(const QString &input);
+    QFuture<QList<QHostAddress>> resolveHost(const QString &host, CancellationToken token);
+
+    /**
+     * @brief Look up every address of a host concurrently.
+     * @param host The host name.
+     * @param token Aborts the DNS and API requests when cancelled.
+     * @return A future with one address data map per address that could be looked up.
+     *
+     * Stored addresses are answered from the database; concurrent requests for the same address
+     * share one API call.
+     */
+    QFuture<QVariantList> lookupHostProfile(const QString &host, CancellationToken token);
+
+    /**
+     * @brief Publish stage for host profiles: emit the aggregated result and show the primary address.
+     * @param host The host name.
+     * @param profile The address data maps from lookupHostProfile().
+     */
+    void publishHostProfile(const QString &host, const QVariantList &profile);
+
+    /**
+     * @brief Fetch and store stage: get the data for an address from the database, or from the API and save it.
+     * @param address The address from resolveTarget(); an empty address is passed through.
+     * @param online True to query the API for addresses that are not stored.
+     * @param token Aborts the request when cancelled; a cancelled lookup is not stored.
+     * @return A future with the address data, or an empty map if nothing was found.
+     */
+    QFuture<QVariantMap> fetchAddressData(const QString &address, bool online, CancellationToken token);
+
+    /**
+     * @brief Publish stage: forward a lookup result to QML.
+     * @param input The input the lookup was for, used in the offline "not found" message.
+     * @param data The address data; empty if the lookup failed.
+     * @param online True if the data came from the API.
+     */
+    void publishResult(const QString &input, const QVariantMap &data, bool online);
 
 signals:
     /**
@@ -128,6 +224,18 @@ signals:
      */
     void requestFinished();
 
+    /**
+     * @brief Signal emitted when the resolveAllAddresses property changes.
+     */
+    void resolveAllAddressesChanged();
+
+    /**
+     * @brief Signal emitted with the aggregated result of a host lookup in resolveAllAddresses mode.
+     * @param host The host name.
+     * @param addresses One map per address, with the same keys as the database records.
+     */
+    void hostProfileReceived(const QString &host, const QVariantList &addresses);
+
     /**
      * @brief Signal emitted when API response data is ready.
      * @param ip The queried IP address.
@@ -0,0 +1,255 @@
+#include "ipScanner.h"
+
+#include <QtAlgorithms>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define GEOCATCH_X86 1
+#  include <immintrin.h>
+#  if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#    define GEOCATCH_TARGET(isa)
+#  else
+#    define GEOCATCH_TARGET(isa) __attribute__((target(isa)))
+#  endif
+#endif
+
+namespace {
+
+using Match = IpScanner::Match;
+
+inline bool isCandidateByte(char c) {
+    return (c >= '0' && c <= '9') || c == '.';
+}
+
+// Report the run [start, end) if it is a complete dotted-quad address
+inline void finishRun(const char *data, qsizetype start, qsizetype end, QList<Match> &matches) {
+    quint32 address = 0;
+    if (end - start >= 7 && IpScanner::parseIpv4(data + start, end - start, &address)) {
+        matches.append({start, end - start, address});
+    }
+}
+
+// Byte-by-byte scan from `i` to `size`, continuing a run that may already be open
+void scanTail(const char *data, qsizetype i, qsizetype size, qsizetype runStart, QList<Match> &matches) {
+    for (; i < size; ++i) {
+        const bool candidate = isCandidateByte(data[i]);
+        if (candidate && runStart < 0) {
+            runStart = i;
+        } else if (!candidate && runStart >= 0) {
+            finishRun(data, runStart, i, matches);
+            runStart = -1;
+        }
+    }
+
+    if (runStart >= 0) {
+        finishRun(data, runStart, size, matches);
+    }
+}
+
+// Walk the buffer in blocks of `Width` bytes. `classify` returns one bit per byte that is a
+// digit or a dot, so blocks with no transitions (plain text, or the middle of a run) cost a
+// single compare. Inlined into the ISA-specific callers so `classify` is inlined too.
+template <int Width, typename Classify>
+Q_ALWAYS_INLINE void scanBlocks(const char *data, qsizetype size, Classify classify, QList<Match> &matches) {
+    constexpr quint64 fullMask = (quint64(1) << Width) - 1;
+    qsizetype runStart = -1;
+    qsizetype i = 0;
+
+    for (; i + Width <= size; i += Width) {
+        const quint64 mask = classify(data + i);
+        if (runStart < 0 ? mask == 0 : mask == fullMask) {
+            continue;
+        }
+
+        for (int bit = 0; bit < Width;) {
+            quint64 remaining = runStart < 0 ? mask : (~mask & fullMask);
+            remaining &= fullMask << bit;
+            if (!remaining) {
+                break;
+            }
+
+            bit = qCountTrailingZeroBits(remaining);
+            if (runStart < 0) {
+                runStart = i + bit;
+            } else {
+                finishRun(data, runStart, i + bit, matches);
+                runStart = -1;
+            }
+        }
+    }
+
+    scanTail(data, i, size, runStart, matches);
+}
+
+#ifdef GEOCATCH_X86
+GEOCATCH_TARGET("sse4.2")
+inline quint64 classifySse42(const char *p) {
+    // Two ranges: '0'-'9' and '.'-'.'
+    const __m128i ranges = _mm_setr_epi8('0', '9', '.', '.', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const __m128i mask = _mm_cmpestrm(ranges, 4, chunk, 16,
+                                      _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_BIT_MASK);
+    return quint32(_mm_cvtsi128_si32(mask)) & 0xFFFFu;
+}
+
+GEOCATCH_TARGET("sse4.2")
+void scanSse42(const char *data, qsizetype size, QList<Match> &matches) {
+    scanBlocks<16>(data, size, classifySse42, matches);
+}
+
+GEOCATCH_TARGET("avx2")
+inline quint64 classifyAvx2(const char *p) {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    // Signed compares: bytes >= 0x80 are negative and never fall inside '0'-'9'
+    const __m256i aboveZero = _mm256_cmpgt_epi8(chunk, _mm256_set1_epi8('0' - 1));
+    const __m256i belowNine = _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chunk);
+    const __m256i dot = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('.'));
+    const __m256i mask = _mm256_or_si256(_mm256_and_si256(aboveZero, belowNine), dot);
+    return quint32(_mm256_movemask_epi8(mask));
+}
+
+GEOCATCH_TARGET("avx2")
+void scanAvx2(const char *data, qsizetype size, QList<Match> &matches) {
+    scanBlocks<32>(data, size, classifyAvx2, matches);
+}
+
+bool cpuSupports(IpScanner::Isa isa) {
+#  if defined(_MSC_VER) && !defined(__clang__)
+    int info[4] = {};
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    if (maxLeaf < 1) {
+        return false;
+    }
+
+    __cpuid(info, 1);
+    const bool sse42 = (info[2] & (1 << 20)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (isa == IpScanner::Isa::Sse42) {
+        return sse42;
+    }
+
+    if (maxLeaf < 7 || !osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#  else
+    __builtin_cpu_init();
+    if (isa == IpScanner::Isa::Sse42) {
+        return __builtin_cpu_supports("sse4.2");
+    }
+    return __builtin_cpu_supports("avx2");
+#  endif
+}
+#endif
+
+} // namespace
+
+bool IpScanner::isSupported(Isa isa) {
+    switch (isa) {
+    case Isa::Auto:
+    case Isa::Scalar:
+        return true;
+    case Isa::Sse42:
+    case Isa::Avx2: {
+#ifdef GEOCATCH_X86
+        static const bool sse42 = cpuSupports(Isa::Sse42);
+        static const bool avx2 = cpuSupports(Isa::Avx2);
+        return isa == Isa::Sse42 ? sse42 : avx2;
+#else
+        return false;
+#endif
+    }
+    }
+    return false;
+}
+
+IpScanner::Isa IpScanner::bestIsa() {
+    static const Isa best = isSupported(Isa::Avx2) ? Isa::Avx2
+                          : isSupported(Isa::Sse42) ? Isa::Sse42
+                          : Isa::Scalar;
+    return best;
+}
+
+QList<IpScanner::Match> IpScanner::scan(const char *data, qsizetype size, Isa isa) {
+    QList<Match> matches;
+    if (!data || size <= 0) {
+        return matches;
+    }
+
+    if (isa == Isa::Auto) {
+        isa = bestIsa();
+    } else if (!isSupported(isa)) {
+        isa = Isa::Scalar;
+    }
+
+    switch (isa) {
+#ifdef GEOCATCH_X86
+    case Isa::Avx2:
+        scanAvx2(data, size, matches);
+        break;
+    case Isa::Sse42:
+        scanSse42(data, size, matches);
+        break;
+#endif
+    default:
+        scanTail(data, 0, size, -1, matches);
+        break;
+    }
+
+    return matches;
+}
+
+QList<IpScanner::Match> IpScanner::scan(const QByteArray &data, Isa isa) {
+    return scan(data.constData(), data.size(), isa);
+}
+
+bool IpScanner::parseIpv4(const char *data, qsizetype size, quint32 *address) {
+    quint32 result = 0;
+    quint32 value = 0;
+    int dots = 0;
+    bool hasDigit = false;
+
+    for (qsizetype i = 0; i < size; ++i) {
+        const char c = data[i];
+        if (c == '.') {
+            if (!hasDigit || dots == 3) {
+                return false;
+            }
+            ++dots;
+            result = (result << 8) | value;
+            value = 0;
+            hasDigit = false;
+        } else if (c >= '0' && c <= '9') {
+            value = value * 10 + quint32(c - '0');
+            if (value > 255) {
+                return false;
+            }
+            hasDigit = true;
+        } else {
+            return false;
+        }
+    }
+
+    if (!hasDigit || dots != 3) {
+        return false;
+    }
+
+    if (address) {
+        *address = (result << 8) | value;
+    }
+    return true;
+}
+
+QByteArray IpScanner::toByteArray(quint32 address) {
+    QByteArray text;
+    text.reserve(15);
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        text += QByteArray::number((address >> shift) & 0xFF);
+        if (shift) {
+            text += '.';
+        }
+    }
+    return text;
+}
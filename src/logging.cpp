@@ -0,0 +1,14 @@
+#include "logging.h"
+
+#ifdef QT_NO_DEBUG
+#  define GEOCATCH_DEFAULT_LOG_LEVEL QtInfoMsg
+#else
+#  define GEOCATCH_DEFAULT_LOG_LEVEL QtDebugMsg
+#endif
+
+Q_LOGGING_CATEGORY(lcDatabase, "geocatch.database", GEOCATCH_DEFAULT_LOG_LEVEL)
+Q_LOGGING_CATEGORY(lcNetwork, "geocatch.network", GEOCATCH_DEFAULT_LOG_LEVEL)
+Q_LOGGING_CATEGORY(lcValidator, "geocatch.validator", GEOCATCH_DEFAULT_LOG_LEVEL)
+Q_LOGGING_CATEGORY(lcImport, "geocatch.import", GEOCATCH_DEFAULT_LOG_LEVEL)
+Q_LOGGING_CATEGORY(lcStartup, "geocatch.startup", GEOCATCH_DEFAULT_LOG_LEVEL)
+Q_LOGGING_CATEGORY(lcTrace, "geocatch.trace", QtInfoMsg)
@@ -6,89 +6,180 @@
 
 #include "networkManager.h"
 #include "databaseManager.h"
+#include "stringDictionary.h"
+#include "logging.h"
+#include "traceBuffer.h"
 
-NetworkManager::NetworkManager(QObject *parent) : QObject(parent) {
+#include <QElapsedTimer>
+#include <QPointer>
+
+NetworkManager::Endpoints &NetworkManager::defaultEndpoints() {
+    static Endpoints endpoints;
+    return endpoints;
+}
+
+void NetworkManager::setDefaultEndpoints(const Endpoints &endpoints) {
+    defaultEndpoints() = endpoints;
+}
+
+NetworkManager::NetworkManager(QObject *parent) : QObject(parent), endpoints(defaultEndpoints()) {
     networkManager = new QNetworkAccessManager(this);
-    checkConnectionStatus();
+
+    // First probe once the event loop is idle instead of during construction
+    QTimer::singleShot(0, this, &NetworkManager::checkConnectionStatus);
 
     connectionTimer = new QTimer(this);
     connect(connectionTimer, &QTimer::timeout, this, &NetworkManager::checkConnectionStatus);
     connectionTimer->start(3000); // Check the connection each 3 seconds
 }
 
-void NetworkManager::makeApiCall(const QString &ip) {
-    QString apiUrl = "https://ipinfo.io/";
-    QString token = "It's not wise to share this :>"; // Your token
-    QString urlString = apiUrl + ip + "/json?token=" + token;
+QFuture<QVariantMap> NetworkManager::fetchAddressData(const QString &ip, CancellationToken token) {
+    QString apiUrl = endpoints.api.toString();
+    QString apiToken = "It's not wise to share this :>"; // Your token
+    QString urlString = apiUrl + ip + "/json?token=" + apiToken;
 
     QUrl url(urlString);
     QNetworkRequest request;
     request.setUrl(url);
 
+    QElapsedTimer requestTimer;
+    requestTimer.start();
+    GEOCATCH_TRACE("api.request", 0, 0);
     QNetworkReply *reply = networkManager->get(request);
+    token.onCancel([reply = QPointer<QNetworkReply>(reply)]() {
+        if (reply) {
+            reply->abort();
+        }
+    });
+
+    // The continuation belongs to this reply only and is released with it
+    return QtFuture::connect(reply, &QNetworkReply::finished).then(this, [reply, ip, requestTimer]() {
+        GEOCATCH_TRACE("api.reply", reply->error(), requestTimer.nsecsElapsed() / 1000);
+        reply->deleteLater();
+
+        if (reply->error() == QNetworkReply::OperationCanceledError) {
+            GEOCATCH_DEBUG_MESSAGE(lcNetwork, "Request for " + ip + " cancelled.");
+            return QVariantMap();
+        }
+
+        if (reply->error() != QNetworkReply::NoError) {
+            qCWarning(lcNetwork) << "Error fetching data for" << ip << ":" << reply->errorString();
+            GEOCATCH_DEBUG_MESSAGE(lcNetwork, "Error fetching data: " + reply->errorString());
+            return QVariantMap();
+        }
 
-    connect(reply, &QNetworkReply::finished, this, [this, reply, ip]() {
-        if (reply->error() == QNetworkReply::NoError) {
-            QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-            QJsonObject jsonObj = jsonResponse.object();
-
-            QVariantMap apiData;
-            apiData["hostname"] = jsonObj["hostname"].toString();
-            apiData["city"] = jsonObj["city"].toString();
-            apiData["region"] = jsonObj["region"].toString();
-            apiData["country"] = jsonObj["country"].toString();
-            apiData["loc"] = jsonObj["loc"].toString();
-            apiData["postal"] = jsonObj["postal"].toString();
-            apiData["timezone"] = jsonObj["timezone"].toString();
-
-            // Save to database
-            if (!DatabaseManager::instance().saveUniqueAddress(ip, apiData)) {
-                emit debugMessage("Address already exists in the database: " + ip);
-            } else {
-                emit debugMessage("Address saved successfully: " + ip);
+        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
+        QJsonObject jsonObj = jsonResponse.object();
+
+        // Repeated fields share the pooled strings instead of holding their own copies. The
+        // stored dictionary has to be loaded before anything new is interned.
+        DatabaseManager::instance().initializeDatabase();
+        StringDictionary &dictionary = StringDictionary::instance();
+        QVariantMap apiData;
+        apiData["address"] = ip;
+        apiData["hostname"] = jsonObj["hostname"].toString();
+        apiData["city"] = dictionary.intern(jsonObj["city"].toString());
+        apiData["region"] = dictionary.intern(jsonObj["region"].toString());
+        apiData["country"] = dictionary.intern(jsonObj["country"].toString());
+        apiData["loc"] = jsonObj["loc"].toString();
+        apiData["postal"] = dictionary.intern(jsonObj["postal"].toString());
+        apiData["timezone"] = dictionary.intern(jsonObj["timezone"].toString());
+        return apiData;
+    });
+}
+
+QFuture<QVariantMap> NetworkManager::fetchAddressDataCoalesced(const QString &ip, CancellationToken token) {
+    std::shared_ptr<PendingFetch> &slot = pendingFetches[ip];
+    if (!slot) {
+        auto pending = std::make_shared<PendingFetch>();
+        pending->future = fetchAddressData(ip, pending->token).then(this, [this, ip, pending](const QVariantMap &data) {
+            if (pendingFetches.value(ip) == pending) {
+                pendingFetches.remove(ip);
             }
+            return data;
+        });
+        slot = pending;
+    } else {
+        GEOCATCH_TRACE("api.coalesced", 0, 0);
+    }
+
+    std::shared_ptr<PendingFetch> pending = slot;
+    ++pending->waiters;
+    token.onCancel([self = QPointer<NetworkManager>(this), ip, pending]() {
+        if (--pending->waiters > 0) {
+            return;
+        }
+        // Nobody is waiting any more; a later caller starts a fresh request
+        if (self && self->pendingFetches.value(ip) == pending) {
+            self->pendingFetches.remove(ip);
+        }
+        pending->token.cancel();
+    });
+    return pending->future;
+}
+
+void NetworkManager::makeApiCall(const QString &ip) {
+    fetchAddressData(ip).then(this, [this, ip](const QVariantMap &apiData) {
+        if (apiData.isEmpty()) {
+            return;
+        }
 
-            emit apiResponseReceived(
-                ip,
-                apiData["hostname"].toString(),
-                apiData["city"].toString(),
-                apiData["region"].toString(),
-                apiData["country"].toString(),
-                apiData["loc"].toString(),
-                apiData["postal"].toString(),
-                apiData["timezone"].toString()
-                );
+        // Save to database
+        if (!DatabaseManager::instance().saveUniqueAddress(ip, apiData)) {
+            GEOCATCH_DEBUG_MESSAGE(lcNetwork, "Address already exists in the database: " + ip);
         } else {
-            emit debugMessage("Error fetching data: " + reply->errorString());
+            GEOCATCH_DEBUG_MESSAGE(lcNetwork, "Address saved successfully: " + ip);
         }
-        reply->deleteLater();
+
+        emit apiResponseReceived(
+            ip,
+            apiData["hostname"].toString(),
+            apiData["city"].toString(),
+            apiData["region"].toString(),
+            apiData["country"].toString(),
+            apiData["loc"].toString(),
+            apiData["postal"].toString(),
+            apiData["timezone"].toString()
+            );
     });
 }
 
-void NetworkManager::resolveLocalhost() {
-    QNetworkRequest request(QUrl("https://api.ipify.org?format=json"));
+QFuture<QString> NetworkManager::fetchPublicIp(CancellationToken token) {
+    QNetworkRequest request(endpoints.publicIp);
 
     QNetworkReply *reply = networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        if (reply->error() == QNetworkReply::NoError) {
-            QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
-            QJsonObject jsonObj = jsonResponse.object();
-            QString publicIP = jsonObj["ip"].toString();
-
-            if (!publicIP.isEmpty()) {
-                emit localhostResolved(publicIP);
-            } else {
-                emit debugMessage("Failed to resolve public IP.");
-            }
-        } else {
-            emit debugMessage("Error resolving public IP: " + reply->errorString());
+    token.onCancel([reply = QPointer<QNetworkReply>(reply)]() {
+        if (reply) {
+            reply->abort();
         }
+    });
+
+    return QtFuture::connect(reply, &QNetworkReply::finished).then(this, [reply]() {
         reply->deleteLater();
+
+        if (reply->error() == QNetworkReply::OperationCanceledError) {
+            GEOCATCH_DEBUG_MESSAGE(lcNetwork, "Public IP request cancelled.");
+            return QString();
+        }
+
+        if (reply->error() != QNetworkReply::NoError) {
+            qCWarning(lcNetwork) << "Error resolving public IP:" << reply->errorString();
+            GEOCATCH_DEBUG_MESSAGE(lcNetwork, "Error resolving public IP: " + reply->errorString());
+            return QString();
+        }
+
+        QJsonDocument jsonResponse = QJsonDocument::fromJson(reply->readAll());
+        QJsonObject jsonObj = jsonResponse.object();
+        QString publicIP = jsonObj["ip"].toString();
+        if (publicIP.isEmpty()) {
+            GEOCATCH_DEBUG_MESSAGE(lcNetwork, "Failed to resolve public IP.");
+        }
+        return publicIP;
     });
 }
 
 void NetworkManager::checkConnectionStatus() {
-    QNetworkRequest request(QUrl("https://www.google.com"));
+    QNetworkRequest request(endpoints.connectionCheck);
     QNetworkReply *reply = networkManager->head(request);
 
     connect(reply, &QNetworkReply::finished, this, [this, reply]() {
@@ -108,7 +199,7 @@ void NetworkManager::setOnline(bool onlineStatus) {
     if (online != onlineStatus) {
         online = onlineStatus;
         emit connectionStatusChanged(online);
-        emit debugMessage("Connection status updated: " + QString(online ? "Online" : "Offline"));
+        GEOCATCH_DEBUG_MESSAGE(lcNetwork, "Connection status updated: " + QString(online ? "Online" : "Offline"));
     }
 }
 
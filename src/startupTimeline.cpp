@@ -0,0 +1,51 @@
+#include "startupTimeline.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDebug>
+
+#include "logging.h"
+
+namespace {
+
+struct TimelineState {
+    QMutex mutex;
+    QElapsedTimer timer;
+    QList<StartupTimeline::Mark> marks;
+};
+
+TimelineState &state() {
+    static TimelineState instance;
+    return instance;
+}
+
+} // namespace
+
+void StartupTimeline::mark(const char *name) {
+    TimelineState &timeline = state();
+    QMutexLocker locker(&timeline.mutex);
+    if (!timeline.timer.isValid()) {
+        timeline.timer.start();
+    }
+    timeline.marks.append({name, timeline.timer.nsecsElapsed()});
+}
+
+QList<StartupTimeline::Mark> StartupTimeline::marks() {
+    TimelineState &timeline = state();
+    QMutexLocker locker(&timeline.mutex);
+    return timeline.marks;
+}
+
+double StartupTimeline::elapsedMs() {
+    TimelineState &timeline = state();
+    QMutexLocker locker(&timeline.mutex);
+    return timeline.timer.isValid() ? timeline.timer.nsecsElapsed() / 1e6 : 0.0;
+}
+
+void StartupTimeline::dump() {
+    for (const Mark &mark : marks()) {
+        qCInfo(lcStartup).nospace() << qSetRealNumberPrecision(2) << Qt::fixed
+                                    << mark.elapsedNs / 1e6 << " ms  " << mark.name;
+    }
+}
@@ -0,0 +1,66 @@
+#include "stringDictionary.h"
+
+#include <QReadLocker>
+#include <QWriteLocker>
+
+quint32 StringDictionary::idFor(const QString &value) {
+    {
+        QReadLocker locker(&lock);
+        auto it = ids.constFind(value);
+        if (it != ids.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QWriteLocker locker(&lock);
+    // Another thread may have added the value between the two locks
+    auto it = ids.constFind(value);
+    if (it != ids.constEnd()) {
+        return it.value();
+    }
+
+    const quint32 id = quint32(values.size());
+    values.append(value);
+    ids.insert(value, id);
+    return id;
+}
+
+QString StringDictionary::intern(const QString &value) {
+    return this->value(idFor(value));
+}
+
+QString StringDictionary::value(quint32 id) const {
+    QReadLocker locker(&lock);
+    if (id >= quint32(values.size())) {
+        return QString();
+    }
+    return values.at(id);
+}
+
+qsizetype StringDictionary::size() const {
+    QReadLocker locker(&lock);
+    return values.size();
+}
+
+QList<QString> StringDictionary::valuesFrom(quint32 firstId) const {
+    QReadLocker locker(&lock);
+    if (firstId >= quint32(values.size())) {
+        return {};
+    }
+    return values.mid(firstId);
+}
+
+bool StringDictionary::restore(const QList<QString> &storedValues) {
+    QWriteLocker locker(&lock);
+    Q_ASSERT_X(values.isEmpty(), "StringDictionary::restore", "dictionary used before storage was opened");
+    if (!values.isEmpty()) {
+        return false;
+    }
+
+    values = storedValues;
+    ids.reserve(values.size());
+    for (qsizetype i = 0; i < values.size(); ++i) {
+        ids.insert(values.at(i), quint32(i));
+    }
+    return true;
+}
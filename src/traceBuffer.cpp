@@ -0,0 +1,63 @@
+#include "traceBuffer.h"
+
+#include <QDebug>
+
+#include <chrono>
+
+TraceBuffer::TraceBuffer() : slots(new Slot[capacity]) {}
+
+void TraceBuffer::record(const char *name, qint64 a, qint64 b) {
+    const quint64 index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = slots[index & (capacity - 1)];
+    const qint64 now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    // Per-slot seqlock: readers discard the slot while the sequence is odd or changes under them
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestampNs.store(now, std::memory_order_relaxed);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.a.store(a, std::memory_order_relaxed);
+    slot.b.store(b, std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+QList<TraceBuffer::Event> TraceBuffer::snapshot() const {
+    QList<Event> events;
+    const quint64 end = writeIndex.load(std::memory_order_acquire);
+    const quint64 begin = end > capacity ? end - capacity : 0;
+    events.reserve(qsizetype(end - begin));
+
+    for (quint64 index = begin; index < end; ++index) {
+        const Slot &slot = slots[index & (capacity - 1)];
+        const quint64 before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * index + 2) {
+            continue; // Still being written, or already overwritten by a newer event
+        }
+
+        Event event;
+        event.timestampNs = slot.timestampNs.load(std::memory_order_relaxed);
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.a = slot.a.load(std::memory_order_relaxed);
+        event.b = slot.b.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before) {
+            events.append(event);
+        }
+    }
+    return events;
+}
+
+void TraceBuffer::dump() const {
+    const QList<Event> events = snapshot();
+    if (events.isEmpty()) {
+        return;
+    }
+
+    const qint64 start = events.first().timestampNs;
+    for (const Event &event : events) {
+        qCInfo(lcTrace).nospace() << "+" << (event.timestampNs - start) / 1000 << "us "
+                                  << event.name << " " << event.a << " " << event.b;
+    }
+}
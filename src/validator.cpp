@@ -3,18 +3,42 @@
 #include <QClipboard>
 #include <QGuiApplication>
 #include <QHostInfo>
+#include <QPromise>
+#include <QSet>
+
+#include <memory>
 
 #include "validator.h"
 #include "networkManager.h"
 #include "databaseManager.h"
+#include "ipScanner.h"
+#include "logging.h"
+#include "traceBuffer.h"
+
+namespace {
+
+template <typename T>
+QFuture<T> readyFuture(T value) {
+    QPromise<T> promise;
+    QFuture<T> future = promise.future();
+    promise.start();
+    promise.addResult(std::move(value));
+    promise.finish();
+    return future;
+}
+
+} // namespace
 
 Validator::Validator(QObject *parent) : QObject(parent), networkManager(new NetworkManager(this)) {
     connect(networkManager, &NetworkManager::apiResponseReceived,
             this, &Validator::handleApiResponse);
 
-    if (!DatabaseManager::instance().initializeDatabase()) {
-        emit databaseError("Failed to initialize the database. Please check your setup.");
-    }
+    // No lookup is running yet
+    activeLookup.cancel();
+
+    // The database is opened lazily; failures are reported whenever initialization runs
+    connect(&DatabaseManager::instance(), &DatabaseManager::databaseError,
+            this, &Validator::databaseError);
 }
 
 bool Validator::isValidIpAddress(const QString &ip) {
@@ -37,7 +61,7 @@ bool Validator::isValidUrl(const QString &url) {
 
 QString Validator::normalizeUrl(const QString &input) {
     QString trimmedInput = input.trimmed();
-    emit debugMessage("Trimmed Input: " + trimmedInput);
+    GEOCATCH_DEBUG_MESSAGE(lcValidator, "Trimmed Input: " + trimmedInput);
 
     if (!trimmedInput.startsWith("http://") && !trimmedInput.startsWith("https://")) {
         if (trimmedInput.startsWith("www.")) {
@@ -46,105 +70,261 @@ QString Validator::normalizeUrl(const QString &input) {
             trimmedInput = "https://www." + trimmedInput;
         }
     }
-    emit debugMessage("Normalized Input with Scheme: " + trimmedInput);
+    GEOCATCH_DEBUG_MESSAGE(lcValidator, "Normalized Input with Scheme: " + trimmedInput);
 
     QUrl url(trimmedInput);
     if (url.isValid() && !url.host().isEmpty()) {
         return url.toString();
     }
 
-    emit debugMessage("Invalid URL after normalization: " + trimmedInput);
+    GEOCATCH_DEBUG_MESSAGE(lcValidator, "Invalid URL after normalization: " + trimmedInput);
     return QString();
 }
 
 void Validator::validateInput(const QString &input) {
-    emit debugMessage("Validation triggered for input: " + input);
+    GEOCATCH_DEBUG_MESSAGE(lcValidator, "Validation triggered for input: " + input);
 
     QString trimmedInput = input.trimmed();
-    emit debugMessage("Trimmed Input: " + trimmedInput);
+    GEOCATCH_DEBUG_MESSAGE(lcValidator, "Trimmed Input: " + trimmedInput);
 
-    // Resolve "localhost"
+    // Validate stage: classify the input before any work is started
+    QString target = trimmedInput;
+    InputKind kind = InputKind::Invalid;
     if (trimmedInput.compare("localhost", Qt::CaseInsensitive) == 0) {
-        emit debugMessage(" Resolving 'localhost' to public IP...");
-        connect(networkManager, &NetworkManager::localhostResolved, this, [this](const QString &publicIP) {
-            emit debugMessage("Resolved localhost to public IP: " + publicIP);
-            networkManager->makeApiCall(publicIP);
-            QTimer::singleShot(1000, this, &Validator::requestFinished);
+        GEOCATCH_DEBUG_MESSAGE(lcValidator, " Resolving 'localhost' to public IP...");
+        kind = InputKind::Localhost;
+    } else if (isValidIpAddress(trimmedInput)) {
+        GEOCATCH_DEBUG_MESSAGE(lcValidator, " Detected as a valid IP address.");
+        kind = InputKind::IpAddress;
+    } else {
+        QString normalizedUrl = normalizeUrl(trimmedInput);
+        if (!normalizedUrl.isEmpty() && isValidUrl(normalizedUrl)) {
+            target = QUrl(normalizedUrl).host();
+            GEOCATCH_DEBUG_MESSAGE(lcValidator, "Detected as a valid URL. Host: " + target);
+            kind = InputKind::Url;
+        }
+    }
+
+    // A new lookup supersedes the previous one: its DNS and HTTP work is aborted and none
+    // of its stages write to the database or emit results after this point
+    if (!activeLookup.isCancelled()) {
+        GEOCATCH_TRACE("lookup.superseded", 0, 0);
+    }
+    activeLookup.cancel();
+    activeLookup = CancellationToken();
+    const CancellationToken token = activeLookup;
+
+    if (kind == InputKind::Invalid) {
+        GEOCATCH_DEBUG_MESSAGE(lcValidator, " Invalid input. Not an IP address or valid URL.");
+        emit validationResult(false, "Invalid input. Not an IP address or valid URL.", "");
+        QTimer::singleShot(1000, this, &Validator::requestFinished);
+        return;
+    }
+
+    DatabaseManager::instance().recordLookup();
+
+    // Every stage is a continuation of this request's own future, so nothing outlives the
+    // lookup and repeated lookups never stack up handlers. A stage that fails passes an empty
+    // value on and the later stages skip their work.
+    const bool online = networkManager->isOnline();
+    if (kind == InputKind::Url && online && resolveAll) {
+        lookupHostProfile(target, token).then(this, [this, target, token](const QVariantList &profile) {
+            if (token.isCancelled()) {
+                return;
+            }
+            publishHostProfile(target, profile);
+            activeLookup.cancel();
+            emit requestFinished();
         });
-        networkManager->resolveLocalhost();
         return;
     }
 
-    // Validate IP address
-    if (isValidIpAddress(trimmedInput)) {
-        emit debugMessage(" Detected as a valid IP address.");
-        if (networkManager->isOnline()) {
-            emit debugMessage("Online mode: Calling NetworkManager::makeApiCall.");
-            networkManager->makeApiCall(trimmedInput);
-            QTimer::singleShot(1000, this, &Validator::requestFinished);
+    resolveTarget(kind, target, online, token)
+        .then(this, [this, online, token](const QString &address) { return fetchAddressData(address, online, token); })
+        .unwrap()
+        .then(this, [this, online, target, token](const QVariantMap &data) {
+            if (token.isCancelled()) {
+                return;
+            }
+            publishResult(target, data, online);
+            activeLookup.cancel(); // Finished, nothing left to abort
+            emit requestFinished();
+        });
+}
+
+QFuture<QString> Validator::resolveTarget(InputKind kind, const QString &target, bool online, CancellationToken token) {
+    if (kind == InputKind::Localhost) {
+        return networkManager->fetchPublicIp(token).then(this, [](const QString &publicIP) {
+            GEOCATCH_DEBUG_MESSAGE(lcValidator, "Resolved localhost to public IP: " + publicIP);
+            return publicIP;
+        });
+    }
+
+    // Offline lookups use the input as stored, without resolving host names
+    if (kind == InputKind::IpAddress || !online) {
+        return readyFuture(target);
+    }
+
+    GEOCATCH_DEBUG_MESSAGE(lcValidator, "Online mode: Resolving URL to IP and making API call.");
+    return resolveHost(target, token).then(this, [this, token](const QList<QHostAddress> &addresses) {
+        if (token.isCancelled() || addresses.isEmpty()) {
+            return QString();
+        }
+        for (const QHostAddress &address : addresses) {
+            if (address.protocol() == QAbstractSocket::IPv4Protocol) {
+                const QString ip = address.toString();
+                GEOCATCH_DEBUG_MESSAGE(lcValidator, " URL resolved to IP: " + ip);
+                emit validationResult(true, "Valid URL. Resolved IP: " + ip, ip);
+                return ip;
+            }
+        }
+        GEOCATCH_DEBUG_MESSAGE(lcValidator, " No valid IPv4 address found for host.");
+        emit validationResult(false, "No IPv4 address found for the host.", "");
+        return QString();
+    });
+}
+
+QFuture<QList<QHostAddress>> Validator::resolveHost(const QString &host, CancellationToken token) {
+    // QHostInfo asks the resolver for A and AAAA records in one query
+    auto promise = std::make_shared<QPromise<QList<QHostAddress>>>();
+    promise->start();
+    const int lookupId = QHostInfo::lookupHost(host, this, [this, promise, token](const QHostInfo &info) {
+        QList<QHostAddress> addresses;
+        if (token.isCancelled()) {
+            // Superseded while the result was queued; no addresses
+        } else if (info.error() == QHostInfo::NoError) {
+            addresses = info.addresses();
         } else {
-            queryDatabase(trimmedInput);
+            GEOCATCH_DEBUG_MESSAGE(lcValidator, ": Host resolution error: " + info.errorString());
+            emit validationResult(false, "Failed to resolve host: " + info.errorString(), "");
+        }
+        promise->addResult(addresses);
+        promise->finish();
+    });
+
+    // An aborted lookup drops its callback, which cancels the promise and the stages after it
+    token.onCancel([lookupId]() { QHostInfo::abortHostLookup(lookupId); });
+    return promise->future();
+}
+
+QFuture<QVariantList> Validator::lookupHostProfile(const QString &host, CancellationToken token) {
+    return resolveHost(host, token).then(this, [this, token](const QList<QHostAddress> &addresses) {
+        // All addresses are looked up at once, so the whole profile costs about one API round trip
+        QList<QFuture<QVariantMap>> lookups;
+        QSet<QString> seen;
+        for (const QHostAddress &address : addresses) {
+            const QString ip = address.toString();
+            if (token.isCancelled() || seen.contains(ip)) {
+                continue;
+            }
+            seen.insert(ip);
+            lookups.append(fetchAddressData(ip, true, token));
+        }
+
+        if (lookups.isEmpty()) {
+            return readyFuture(QVariantList());
         }
-        return;
-    }
 
-    // Validate and resolve URL
-    QString normalizedUrl = normalizeUrl(trimmedInput);
-    if (!normalizedUrl.isEmpty() && isValidUrl(normalizedUrl)) {
-        QUrl url(normalizedUrl);
-        emit debugMessage("Detected as a valid URL. Host: " + url.host());
-        if (networkManager->isOnline()) {
-            emit debugMessage("Online mode: Resolving URL to IP and making API call.");
-            QHostInfo::lookupHost(url.host(), this, [this, normalizedUrl](const QHostInfo &host) {
-                if (host.error() == QHostInfo::NoError) {
-                    for (const QHostAddress &address : host.addresses()) {
-                        if (address.protocol() == QAbstractSocket::IPv4Protocol) {
-                            QString ip = address.toString();
-                            emit debugMessage(" URL resolved to IP: " + ip);
-                            emit validationResult(true, "Valid URL. Resolved IP: " + ip, ip);
-                            networkManager->makeApiCall(ip); // Use the resolved IP for the API call
-                            QTimer::singleShot(1000, this, &Validator::requestFinished);
-                            return;
-                        }
+        return QtFuture::whenAll(lookups.begin(), lookups.end())
+            .then(this, [](const QList<QFuture<QVariantMap>> &results) {
+                QVariantList profile;
+                for (const QFuture<QVariantMap> &result : results) {
+                    if (!result.isCanceled() && result.resultCount() > 0 && !result.result().isEmpty()) {
+                        profile.append(result.result());
                     }
-                    emit debugMessage(" No valid IPv4 address found for host.");
-                    emit validationResult(false, "No IPv4 address found for the host.", "");
-                } else {
-                    emit debugMessage(": Host resolution error: " + host.errorString());
-                    emit validationResult(false, "Failed to resolve host: " + host.errorString(), "");
                 }
-                QTimer::singleShot(1000, this, &Validator::requestFinished);
+                return profile;
             });
-        } else {
-            queryDatabase(url.host());
-        }
+    }).unwrap();
+}
+
+void Validator::publishHostProfile(const QString &host, const QVariantList &profile) {
+    if (profile.isEmpty()) {
+        GEOCATCH_DEBUG_MESSAGE(lcValidator, " No addresses found for host: " + host);
+        emit validationResult(false, "No addresses found for the host.", "");
         return;
     }
 
-    // Invalid input
-    emit debugMessage(" Invalid input. Not an IP address or valid URL.");
-    emit validationResult(false, "Invalid input. Not an IP address or valid URL.", "");
-    QTimer::singleShot(1000, this, &Validator::requestFinished);
+    // The first IPv4 record fills the single-result view
+    QVariantMap primary = profile.first().toMap();
+    int ipv4Count = 0;
+    for (const QVariant &entry : profile) {
+        const QVariantMap record = entry.toMap();
+        if (QHostAddress(record.value("address").toString()).protocol() == QAbstractSocket::IPv4Protocol) {
+            if (ipv4Count++ == 0) {
+                primary = record;
+            }
+        }
+    }
+
+    const QString summary = QString("Resolved %1 addresses for %2 (%3 IPv4, %4 IPv6).")
+                                .arg(profile.size()).arg(host).arg(ipv4Count).arg(profile.size() - ipv4Count);
+    GEOCATCH_DEBUG_MESSAGE(lcValidator, summary);
+    emit validationResult(true, summary, primary.value("address").toString());
+    emit hostProfileReceived(host, profile);
+    publishResult(host, primary, true);
+}
+
+QFuture<QVariantMap> Validator::fetchAddressData(const QString &address, bool online, CancellationToken token) {
+    if (address.isEmpty() || token.isCancelled()) {
+        return readyFuture(QVariantMap());
+    }
+
+    if (!online) {
+        GEOCATCH_DEBUG_MESSAGE(lcValidator, "Offline mode: Searching database for input: " + address);
+        return readyFuture(DatabaseManager::instance().getSpecificAddressData(address));
+    }
+
+    // Stored records never change, so a hit (usually from the warmed record cache) skips the API
+    const QVariantMap stored = DatabaseManager::instance().getSpecificAddressData(address);
+    if (!stored.isEmpty()) {
+        GEOCATCH_DEBUG_MESSAGE(lcValidator, "Online mode: Serving stored data for: " + address);
+        return readyFuture(stored);
+    }
+
+    // Store stage: API results are saved before they are shown
+    GEOCATCH_DEBUG_MESSAGE(lcValidator, "Online mode: Calling NetworkManager::fetchAddressData.");
+    return networkManager->fetchAddressDataCoalesced(address, token).then(this, [address, token](const QVariantMap &data) {
+        if (token.isCancelled()) {
+            return QVariantMap();
+        }
+        if (!data.isEmpty() && !DatabaseManager::instance().saveUniqueAddress(address, data)) {
+            GEOCATCH_DEBUG_MESSAGE(lcValidator, "Address already exists in the database: " + address);
+        }
+        return data;
+    });
 }
 
-void Validator::queryDatabase(const QString &input) {
-    emit debugMessage("Offline mode: Searching database for input: " + input);
-    QVariantMap data = DatabaseManager::instance().getSpecificAddressData(input);
+void Validator::publishResult(const QString &input, const QVariantMap &data, bool online) {
     if (data.isEmpty()) {
-        emit debugMessage("No data found in database for input: " + input);
-        emit validationResult(false, "No data found in the database.", input);
-    } else {
-        emit debugMessage("Data retrieved from database for input: " + input);
-        emit networkManager->apiResponseReceived(data["address"].toString(),
-                                 data["hostname"].toString(),
-                                 data["city"].toString(),
-                                 data["region"].toString(),
-                                 data["country"].toString(),
-                                 data["loc"].toString(),
-                                 data["postal"].toString(),
-                                 data["timezone"].toString());
+        if (!online) {
+            GEOCATCH_DEBUG_MESSAGE(lcValidator, "No data found in database for input: " + input);
+            emit validationResult(false, "No data found in the database.", input);
+        }
+        return;
+    }
+
+    GEOCATCH_DEBUG_MESSAGE(lcValidator, "Validator forwarding lookup result to QML.");
+    DatabaseManager::instance().recordAddressLookup(data["address"].toString());
+    emit apiResponseReceived(data["address"].toString(),
+                             data["hostname"].toString(),
+                             data["city"].toString(),
+                             data["region"].toString(),
+                             data["country"].toString(),
+                             data["loc"].toString(),
+                             data["postal"].toString(),
+                             data["timezone"].toString());
+}
+
+bool Validator::resolveAllAddresses() const {
+    return resolveAll;
+}
+
+void Validator::setResolveAllAddresses(bool enabled) {
+    if (resolveAll != enabled) {
+        resolveAll = enabled;
+        emit resolveAllAddressesChanged();
     }
-    QTimer::singleShot(1000, this, &Validator::requestFinished);
 }
 
 QList<QString> Validator::retrieveData() {
@@ -158,13 +338,38 @@ bool Validator::clearDatabase() {
 void Validator::copyToClipboard(const QString &text) {
     QClipboard *clipboard = QGuiApplication::clipboard();
     clipboard->setText(text, QClipboard::Clipboard);
-    emit debugMessage("Copied to clipboard: " + text);
+    GEOCATCH_DEBUG_MESSAGE(lcValidator, "Copied to clipboard: " + text);
+}
+
+QVariantList Validator::statistics(const QString &dimension) {
+    return DatabaseManager::instance().getGroupCounts(dimension);
+}
+
+QVariantList Validator::lookupVolume(int hours) {
+    return DatabaseManager::instance().getLookupVolume(hours);
+}
+
+qint64 Validator::storedAddressCount() {
+    return DatabaseManager::instance().getAddressCount();
+}
+
+QList<QString> Validator::extractIpAddresses(const QString &text) {
+    QList<QString> addresses;
+    const QByteArray utf8 = text.toUtf8();
+    const QList<IpScanner::Match> matches = IpScanner::scan(utf8);
+    addresses.reserve(matches.size());
+    for (const IpScanner::Match &match : matches) {
+        addresses.append(QString::fromLatin1(IpScanner::toByteArray(match.address)));
+    }
+
+    GEOCATCH_DEBUG_MESSAGE(lcValidator, "Extracted " + QString::number(addresses.size()) + " IP addresses from text.");
+    return addresses;
 }
 
 void Validator::handleApiResponse(const QString &ip, const QString &hostname, const QString &city,
                                   const QString &region, const QString &country, const QString &loc,
                                   const QString &postal, const QString &timezone) {
     // Forward the signal to QML
-    emit debugMessage("Validator forwarding API response to QML.");
+    GEOCATCH_DEBUG_MESSAGE(lcValidator, "Validator forwarding API response to QML.");
     emit apiResponseReceived(ip, hostname, city, region, country, loc, postal, timezone);
 }
@@ -0,0 +1,232 @@
+#include <QtTest>
+#include <QFile>
+#include <QHostAddress>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+#include <algorithm>
+
+#include "columnarExporter.h"
+#include "databaseManager.h"
+#include "datasetImporter.h"
+#include "stringDictionary.h"
+
+// Exports a small sharded store and reads the file back by following the layout documented in
+// columnarExporter.h, so the reader below doubles as a reference for analysts.
+class ColumnarExportTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void testRoundTrip();
+
+private:
+    struct ExpectedRow {
+        QString hostname;
+        QStringList dictionaryFields; ///< city, region, country, postal, timezone
+        double latitude = 0;
+        double longitude = 0;
+    };
+
+    /**
+     * Bounds-checked little-endian reader over the exported file.
+     */
+    struct Reader {
+        QByteArray data;
+        qsizetype pos = 0;
+        bool ok = true;
+
+        template <typename T>
+        T read() {
+            if (pos + qsizetype(sizeof(T)) > data.size()) {
+                ok = false;
+                return T();
+            }
+            const T value = qFromLittleEndian<T>(data.constData() + pos);
+            pos += sizeof(T);
+            return value;
+        }
+
+        QByteArray bytes(qsizetype size) {
+            if (size < 0 || pos + size > data.size()) {
+                ok = false;
+                return {};
+            }
+            const QByteArray value = data.mid(pos, size);
+            pos += size;
+            return value;
+        }
+    };
+
+    static QStringList decodeStrings(const QByteArray &column, qsizetype count);
+    static QString decodeAddress(const char *key);
+
+    QTemporaryDir storage;
+    QString csvPath;
+    QHash<QString, ExpectedRow> expected;
+};
+
+QStringList ColumnarExportTest::decodeStrings(const QByteArray &column, qsizetype count) {
+    const qsizetype dataStart = (count + 1) * qsizetype(sizeof(quint32));
+    if (column.size() < dataStart) {
+        return {};
+    }
+
+    QStringList values;
+    for (qsizetype i = 0; i < count; ++i) {
+        const quint32 begin = qFromLittleEndian<quint32>(column.constData() + i * sizeof(quint32));
+        const quint32 end = qFromLittleEndian<quint32>(column.constData() + (i + 1) * sizeof(quint32));
+        values.append(QString::fromUtf8(column.mid(dataStart + begin, end - begin)));
+    }
+    return values;
+}
+
+QString ColumnarExportTest::decodeAddress(const char *key) {
+    static const char mappedPrefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, char(0xff), char(0xff)};
+    if (std::equal(key, key + 12, mappedPrefix)) {
+        return QHostAddress(qFromBigEndian<quint32>(key + 12)).toString();
+    }
+
+    Q_IPV6ADDR ipv6;
+    std::copy(key, key + 16, ipv6.c);
+    return QHostAddress(ipv6).toString();
+}
+
+void ColumnarExportTest::initTestCase() {
+    QVERIFY(storage.isValid());
+    QVERIFY(DatabaseManager::instance().setStorageLocation(storage.filePath("store"), 2));
+    QVERIFY(DatabaseManager::instance().initializeDatabase());
+
+    // Enough rows for several row groups at the minimum group size, with repeated fields
+    static const char *cities[] = {"Berlin", "Sydney", "Zürich", "São Paulo"};
+    static const char *countries[] = {"DE", "AU", "CH", "BR"};
+    QByteArray csv = "ip,hostname,city,region,country,lat,lon,postal,timezone\n";
+    for (int i = 0; i < 3000; ++i) {
+        const int place = i % 4;
+        const QString written = i % 100 == 0 ? QString("2001:db8::%1").arg(i + 1, 0, 16)
+                                              : QString("10.%1.%2.%3").arg(i / 65536).arg(i / 256 % 256).arg(i % 256);
+        const QString address = QHostAddress(written).toString();
+        ExpectedRow row;
+        row.hostname = QString("host-%1.example.net").arg(i);
+        row.dictionaryFields = {cities[place], QString("Region %1").arg(place), countries[place],
+                                QString::number(10000 + place), QString("Zone/%1").arg(place)};
+        row.latitude = 10.5 + place;
+        row.longitude = -20.25 - place;
+        expected.insert(address, row);
+
+        csv += QString("%1,%2,%3,%4,%5,%6,%7,%8,%9\n")
+                   .arg(address, row.hostname, row.dictionaryFields.at(0), row.dictionaryFields.at(1),
+                        row.dictionaryFields.at(2), QString::number(row.latitude), QString::number(row.longitude),
+                        row.dictionaryFields.at(3), row.dictionaryFields.at(4))
+                   .toUtf8();
+    }
+
+    csvPath = storage.filePath("dataset.csv");
+    QFile file(csvPath);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(csv), qint64(csv.size()));
+    file.close();
+
+    DatasetImporter importer;
+    const DatasetImporter::Summary summary = importer.importFile(csvPath);
+    QVERIFY(summary.ok);
+    QCOMPARE(summary.insertedRows, qint64(expected.size()));
+}
+
+void ColumnarExportTest::testRoundTrip() {
+    const QString exportPath = storage.filePath("addresses.gccf");
+    ColumnarExporter exporter;
+    exporter.setRowGroupSize(1024);
+    const ColumnarExporter::Summary summary = exporter.exportFile(exportPath);
+    QVERIFY(summary.ok);
+    QCOMPARE(summary.rows, qint64(expected.size()));
+    QVERIFY2(summary.bytes < QFileInfo(csvPath).size(), "Columnar export is not smaller than the CSV");
+
+    QFile file(exportPath);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    Reader reader{file.readAll()};
+    QCOMPARE(reader.data.size(), summary.bytes);
+
+    // Header
+    QCOMPARE(reader.bytes(4), QByteArray("GCCF"));
+    QCOMPARE(reader.read<quint32>(), quint32(1));
+    const quint32 columnCount = reader.read<quint32>();
+    QStringList names;
+    QList<quint8> types;
+    for (quint32 i = 0; i < columnCount; ++i) {
+        types.append(reader.read<quint8>());
+        names.append(QString::fromUtf8(reader.bytes(reader.read<quint16>())));
+    }
+    QVERIFY(reader.ok);
+    QCOMPARE(names, QStringList({"address", "hostname", "city", "region", "country", "postal", "timezone",
+                                 "latitude", "longitude", "change_seq"}));
+    QCOMPARE(types, QList<quint8>({1, 2, 3, 3, 3, 3, 3, 4, 4, 5}));
+    const qsizetype firstRowGroup = reader.pos;
+
+    // Footer, located from the end of the file
+    QCOMPARE(reader.data.right(4), QByteArray("GCCF"));
+    const quint32 footerLength = qFromLittleEndian<quint32>(reader.data.constData() + reader.data.size() - 8);
+    reader.pos = reader.data.size() - 8 - footerLength;
+    const quint64 dictionaryOffset = reader.read<quint64>();
+    QCOMPARE(reader.read<quint64>(), quint64(expected.size()));
+    const quint32 rowGroupCount = reader.read<quint32>();
+    QCOMPARE(rowGroupCount, quint32((expected.size() + 1023) / 1024));
+    QList<quint64> rowGroupOffsets;
+    for (quint32 i = 0; i < rowGroupCount; ++i) {
+        rowGroupOffsets.append(reader.read<quint64>());
+    }
+    QVERIFY(reader.ok);
+    QCOMPARE(reader.pos, reader.data.size() - 8);
+    QCOMPARE(rowGroupOffsets.first(), quint64(firstRowGroup));
+
+    // Dictionary section
+    reader.pos = qsizetype(dictionaryOffset);
+    const quint32 dictionarySize = reader.read<quint32>();
+    const QStringList dictionary = decodeStrings(qUncompress(reader.bytes(reader.read<quint32>())), dictionarySize);
+    QVERIFY(reader.ok);
+    QCOMPARE(dictionary, QStringList(StringDictionary::instance().valuesFrom(0)));
+    QCOMPARE(reader.pos, reader.data.size() - 8 - qsizetype(footerLength));
+
+    // Row groups, each starting where the footer says and ending where the next one starts
+    QSet<QString> seen;
+    for (quint32 group = 0; group < rowGroupCount; ++group) {
+        reader.pos = qsizetype(rowGroupOffsets.at(group));
+        const quint32 rows = reader.read<quint32>();
+        QList<QByteArray> columns;
+        for (quint32 column = 0; column < columnCount; ++column) {
+            columns.append(qUncompress(reader.bytes(reader.read<quint32>())));
+        }
+        QVERIFY(reader.ok);
+        const quint64 groupEnd = group + 1 < rowGroupCount ? rowGroupOffsets.at(group + 1) : dictionaryOffset;
+        QCOMPARE(quint64(reader.pos), groupEnd);
+
+        QCOMPARE(columns.at(0).size(), qsizetype(rows) * 16);
+        const QStringList hostnames = decodeStrings(columns.at(1), rows);
+        QCOMPARE(hostnames.size(), qsizetype(rows));
+        for (int column = 2; column <= 9; ++column) {
+            QCOMPARE(columns.at(column).size(), qsizetype(rows) * (column <= 6 ? 4 : 8));
+        }
+
+        for (quint32 row = 0; row < rows; ++row) {
+            const QString address = decodeAddress(columns.at(0).constData() + row * 16);
+            QVERIFY2(expected.contains(address), qPrintable("Unexpected address " + address));
+            QVERIFY2(!seen.contains(address), qPrintable("Duplicate address " + address));
+            seen.insert(address);
+
+            const ExpectedRow &want = expected.value(address);
+            QCOMPARE(hostnames.at(row), want.hostname);
+            for (int field = 0; field < 5; ++field) {
+                const quint32 id = qFromLittleEndian<quint32>(columns.at(2 + field).constData() + row * 4);
+                QVERIFY(id < quint32(dictionary.size()));
+                QCOMPARE(dictionary.at(id), want.dictionaryFields.at(field));
+            }
+            QCOMPARE(qFromLittleEndian<double>(columns.at(7).constData() + row * 8), want.latitude);
+            QCOMPARE(qFromLittleEndian<double>(columns.at(8).constData() + row * 8), want.longitude);
+            QVERIFY(qFromLittleEndian<qint64>(columns.at(9).constData() + row * 8) > 0);
+        }
+    }
+    QCOMPARE(seen.size(), expected.size());
+}
+
+QTEST_GUILESS_MAIN(ColumnarExportTest)
+#include "columnarExportTest.moc"
@@ -0,0 +1,103 @@
+#include <QtTest>
+#include <QProcess>
+#include <QTemporaryDir>
+
+#include "databaseManager.h"
+#include "deltaSync.h"
+
+// Imports a delta written by a second store. The DatabaseManager is a process-wide singleton,
+// so the second store lives in a child run of this executable (see main()).
+class DeltaSyncTest : public QObject {
+    Q_OBJECT
+
+public:
+    static QVariantMap remoteRecord(const QString &address);
+    static QStringList remoteAddresses();
+
+private slots:
+    void initTestCase();
+    void testImportDeltaFromSecondStore();
+
+private:
+    QTemporaryDir localStore;
+    QTemporaryDir remoteStore;
+};
+
+QStringList DeltaSyncTest::remoteAddresses() {
+    return {"1.1.1.1", "8.8.8.8", "2001:4860:4860::8888"};
+}
+
+QVariantMap DeltaSyncTest::remoteRecord(const QString &address) {
+    QVariantMap data;
+    data["hostname"] = "remote-" + address;
+    data["city"] = address.contains(':') ? "Mountain View" : "Sydney";
+    data["region"] = address.contains(':') ? "California" : "New South Wales";
+    data["country"] = address.contains(':') ? "US" : "AU";
+    data["loc"] = "0.0,0.0";
+    data["postal"] = "1000";
+    data["timezone"] = address.contains(':') ? "America/Los_Angeles" : "Australia/Sydney";
+    return data;
+}
+
+void DeltaSyncTest::initTestCase() {
+    QVERIFY(localStore.isValid());
+    QVERIFY(remoteStore.isValid());
+    QVERIFY(DatabaseManager::instance().setStorageLocation(localStore.path(), 0));
+}
+
+void DeltaSyncTest::testImportDeltaFromSecondStore() {
+    const QString deltaPath = remoteStore.filePath("changes.gcdl");
+
+    QProcess exporter;
+    exporter.start(QCoreApplication::applicationFilePath(), {"--export-store", remoteStore.path(), deltaPath});
+    QVERIFY(exporter.waitForFinished(30000));
+    QCOMPARE(exporter.exitCode(), 0);
+
+    // An address that is already stored keeps its local data
+    DatabaseManager &database = DatabaseManager::instance();
+    QVariantMap local = remoteRecord("8.8.8.8");
+    local["city"] = "Local City";
+    QVERIFY(database.addAddress("8.8.8.8", local));
+
+    DeltaSync sync;
+    QCOMPARE(sync.importChanges(deltaPath), qint64(2));
+
+    QCOMPARE(database.getSpecificAddressData("1.1.1.1").value("city").toString(), QString("Sydney"));
+    QCOMPARE(database.getSpecificAddressData("1.1.1.1").value("hostname").toString(), QString("remote-1.1.1.1"));
+    QCOMPARE(database.getSpecificAddressData("2001:4860:4860::8888").value("timezone").toString(),
+             QString("America/Los_Angeles"));
+    QCOMPARE(database.getSpecificAddressData("8.8.8.8").value("city").toString(), QString("Local City"));
+
+    // Merging the same file again adds nothing
+    QCOMPARE(sync.importChanges(deltaPath), qint64(0));
+}
+
+// Child mode: fill a separate, sharded store and export everything it holds
+static int exportSecondStore(const QString &directory, const QString &deltaPath) {
+    DatabaseManager &database = DatabaseManager::instance();
+    if (!database.setStorageLocation(directory, 2) || !database.initializeDatabase()) {
+        return 1;
+    }
+
+    for (const QString &address : DeltaSyncTest::remoteAddresses()) {
+        if (!database.addAddress(address, DeltaSyncTest::remoteRecord(address))) {
+            return 1;
+        }
+    }
+
+    DeltaSync sync;
+    return sync.exportChanges(deltaPath, 0) < 0 ? 1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    const QStringList arguments = app.arguments();
+    if (arguments.size() == 4 && arguments.at(1) == "--export-store") {
+        return exportSecondStore(arguments.at(2), arguments.at(3));
+    }
+
+    DeltaSyncTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "deltaSyncTest.moc"
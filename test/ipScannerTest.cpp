@@ -0,0 +1,119 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include <QElapsedTimer>
+#include "ipScanner.h"
+
+class IpScannerTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testKnownInputs();
+    void testFuzzAgainstValidator();
+    void benchmarkThroughput();
+
+private:
+    static bool referenceIsValidIp(const QString &ip);
+    static QList<IpScanner::Isa> supportedIsas();
+};
+
+// Same logic as Validator::isValidIpAddress
+bool IpScannerTest::referenceIsValidIp(const QString &ip) {
+    QStringList parts = ip.split('.');
+    if (parts.size() != 4) return false;
+
+    for (const QString &part : parts) {
+        bool ok;
+        int number = part.toInt(&ok);
+        if (!ok || number < 0 || number > 255) return false;
+    }
+
+    return true;
+}
+
+QList<IpScanner::Isa> IpScannerTest::supportedIsas() {
+    QList<IpScanner::Isa> isas;
+    for (IpScanner::Isa isa : {IpScanner::Isa::Scalar, IpScanner::Isa::Sse42, IpScanner::Isa::Avx2}) {
+        if (IpScanner::isSupported(isa)) {
+            isas.append(isa);
+        }
+    }
+    return isas;
+}
+
+void IpScannerTest::testKnownInputs() {
+    const QByteArray text = "a 1.2.3.4 b 256.1.1.1 c 10.0.0.255,192.168.1.1.5 9.9.9.9";
+    for (IpScanner::Isa isa : supportedIsas()) {
+        const QList<IpScanner::Match> matches = IpScanner::scan(text, isa);
+        QCOMPARE(matches.size(), 3);
+        QCOMPARE(matches[0].offset, 2);
+        QCOMPARE(IpScanner::toByteArray(matches[0].address), QByteArray("1.2.3.4"));
+        QCOMPARE(IpScanner::toByteArray(matches[1].address), QByteArray("10.0.0.255"));
+        QCOMPARE(IpScanner::toByteArray(matches[2].address), QByteArray("9.9.9.9"));
+    }
+}
+
+void IpScannerTest::testFuzzAgainstValidator() {
+    // Digit-heavy alphabet so that many runs are close to valid addresses
+    static const char alphabet[] = "0123456789012345....2255 x\n\xC3";
+    QRandomGenerator rng(20241018);
+
+    for (int iteration = 0; iteration < 20000; ++iteration) {
+        QByteArray text;
+        const int length = rng.bounded(200);
+        for (int i = 0; i < length; ++i) {
+            text += alphabet[rng.bounded(int(sizeof(alphabet) - 1))];
+        }
+
+        // Expected: every maximal run of digits and dots the validator accepts
+        QList<QPair<qsizetype, qsizetype>> expected;
+        for (qsizetype i = 0; i < text.size();) {
+            if (!(text[i] >= '0' && text[i] <= '9') && text[i] != '.') {
+                ++i;
+                continue;
+            }
+            const qsizetype start = i;
+            while (i < text.size() && ((text[i] >= '0' && text[i] <= '9') || text[i] == '.')) {
+                ++i;
+            }
+            if (referenceIsValidIp(QString::fromLatin1(text.mid(start, i - start)))) {
+                expected.append({start, i - start});
+            }
+        }
+
+        for (IpScanner::Isa isa : supportedIsas()) {
+            const QList<IpScanner::Match> matches = IpScanner::scan(text, isa);
+            QCOMPARE(matches.size(), expected.size());
+            for (qsizetype i = 0; i < matches.size(); ++i) {
+                QCOMPARE(matches[i].offset, expected[i].first);
+                QCOMPARE(matches[i].length, expected[i].second);
+            }
+        }
+    }
+}
+
+void IpScannerTest::benchmarkThroughput() {
+    // Small by default so plain ctest stays cheap; GEOCATCH_SCAN_BENCH_MB sizes a real measurement
+    bool ok = false;
+    const int sizeMb = qEnvironmentVariableIntValue("GEOCATCH_SCAN_BENCH_MB", &ok);
+    const qsizetype bufferSize = qsizetype(ok && sizeMb > 0 ? sizeMb : 4) * 1024 * 1024;
+
+    const QByteArray line = "GET /index.html HTTP/1.1 client 192.168.10.23 status 200 bytes 5123 agent Mozilla/5.0\n";
+    QByteArray buffer;
+    buffer.reserve(bufferSize);
+    while (buffer.size() + line.size() <= bufferSize) {
+        buffer += line;
+    }
+
+    for (IpScanner::Isa isa : supportedIsas()) {
+        QElapsedTimer timer;
+        timer.start();
+        const QList<IpScanner::Match> matches = IpScanner::scan(buffer, isa);
+        const qint64 elapsedNs = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+        QCOMPARE(matches.size(), buffer.size() / line.size());
+        qInfo() << "ISA" << int(isa) << "throughput:" << double(buffer.size()) / elapsedNs << "GB/s";
+    }
+}
+
+QTEST_MAIN(IpScannerTest)
+#include "ipScannerTest.moc"
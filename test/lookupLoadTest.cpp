@@ -0,0 +1,339 @@
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+#include "mockGeoApi.h"
+#include "cacheWarmer.h"
+#include "networkManager.h"
+#include "validator.h"
+#include "databaseManager.h"
+
+// Functional checks against the mock API, plus fixed-duration soak runs that report
+// throughput, latency percentiles and memory growth. The soak runs are short by default;
+// GEOCATCH_SOAK_SECONDS, GEOCATCH_SOAK_CONCURRENCY, GEOCATCH_SOAK_CLIENTS and
+// GEOCATCH_SOAK_MAX_GROWTH_MB scale them up for real soak testing.
+class LookupLoadTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void testFetchParsesApiResponse();
+    void testFailedResponsesYieldNoData();
+    void testCancellationAbortsRequest();
+    void testRepeatedLocalhostLookupsStayConstant();
+    void testHotAddressRanking();
+    void testWarmedAddressSkipsApi();
+    void soakNetworkManager();
+    void soakValidator();
+
+private:
+    struct LoadReport {
+        qint64 completed = 0;
+        qint64 failed = 0;
+        double seconds = 0;
+        QList<qint64> latenciesUs;
+        qint64 rssAfterWarmupKb = -1;
+        qint64 rssAtEndKb = -1;
+    };
+
+    static int envInt(const char *name, int defaultValue);
+    static qint64 residentSetKb();
+    static qint64 percentile(QList<qint64> &sorted, double fraction);
+    static QString randomPoolAddress(QRandomGenerator &rng);
+    void printAndCheck(const char *name, LoadReport &report);
+
+    /**
+     * Keep `concurrency` lookups in flight for the soak duration. `start` begins one lookup
+     * and must call the passed completion exactly once with whether it succeeded.
+     */
+    LoadReport runLoad(int concurrency, const std::function<void(int slot, std::function<void(bool)>)> &start);
+
+    MockGeoApi api;
+    QTemporaryDir storage;
+};
+
+int LookupLoadTest::envInt(const char *name, int defaultValue) {
+    bool ok = false;
+    const int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok && value > 0 ? value : defaultValue;
+}
+
+qint64 LookupLoadTest::residentSetKb() {
+    // Linux only; other platforms report no memory figures
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    return fields.size() > 1 ? fields.at(1).toLongLong() * 4 : -1;
+}
+
+qint64 LookupLoadTest::percentile(QList<qint64> &sorted, double fraction) {
+    if (sorted.isEmpty()) {
+        return 0;
+    }
+    return sorted.at(qMin(qsizetype(fraction * sorted.size()), sorted.size() - 1));
+}
+
+QString LookupLoadTest::randomPoolAddress(QRandomGenerator &rng) {
+    // A bounded pool, so the database stops growing after warm-up and memory growth means a leak
+    return QString("10.%1.%2.%3").arg(rng.bounded(4)).arg(rng.bounded(32)).arg(rng.bounded(32));
+}
+
+void LookupLoadTest::initTestCase() {
+    QVERIFY(api.listen());
+    QVERIFY(storage.isValid());
+
+    NetworkManager::Endpoints endpoints;
+    endpoints.api = api.apiUrl();
+    endpoints.publicIp = api.publicIpUrl();
+    endpoints.connectionCheck = api.connectionCheckUrl();
+    NetworkManager::setDefaultEndpoints(endpoints);
+
+    QVERIFY(DatabaseManager::instance().setStorageLocation(storage.path(), 1));
+    QVERIFY(DatabaseManager::instance().initializeDatabase());
+}
+
+void LookupLoadTest::init() {
+    api.setLatency(MockGeoApi::Latency::Fixed, 0);
+    api.setErrorRate(0);
+    api.setRateLimitRate(0);
+    api.resetCounters();
+}
+
+void LookupLoadTest::testFetchParsesApiResponse() {
+    NetworkManager manager;
+    QFuture<QVariantMap> future = manager.fetchAddressData("8.8.8.8");
+    QTRY_VERIFY(future.isFinished());
+
+    const QVariantMap data = future.result();
+    QCOMPARE(data.value("address").toString(), QString("8.8.8.8"));
+    QCOMPARE(data.value("hostname").toString(), QString("host-8-8-8-8.example.net"));
+    QCOMPARE(data.value("timezone").toString(), QString("Europe/Berlin"));
+    QCOMPARE(api.apiRequests(), 1);
+}
+
+void LookupLoadTest::testFailedResponsesYieldNoData() {
+    NetworkManager manager;
+
+    api.setRateLimitRate(1);
+    QFuture<QVariantMap> limited = manager.fetchAddressData("1.1.1.1");
+    QTRY_VERIFY(limited.isFinished());
+    QVERIFY(limited.result().isEmpty());
+
+    api.setRateLimitRate(0);
+    api.setErrorRate(1);
+    QFuture<QVariantMap> failed = manager.fetchAddressData("1.1.1.1");
+    QTRY_VERIFY(failed.isFinished());
+    QVERIFY(failed.result().isEmpty());
+    QCOMPARE(api.failedResponses(), 2);
+}
+
+void LookupLoadTest::testCancellationAbortsRequest() {
+    NetworkManager manager;
+    api.setLatency(MockGeoApi::Latency::Fixed, 5000);
+
+    CancellationToken token;
+    QElapsedTimer timer;
+    timer.start();
+    QFuture<QVariantMap> future = manager.fetchAddressData("9.9.9.9", token);
+    QTRY_COMPARE(api.apiRequests(), 1);
+    token.cancel();
+
+    QTRY_VERIFY_WITH_TIMEOUT(future.isFinished(), 1000);
+    QVERIFY(future.result().isEmpty());
+    QVERIFY(timer.elapsed() < 5000);
+}
+
+void LookupLoadTest::testRepeatedLocalhostLookupsStayConstant() {
+    // Each localhost lookup used to add another permanent handler, so lookup N made N API calls
+    Validator validator;
+    int finished = 0;
+    connect(&validator, &Validator::requestFinished, this, [&finished]() { ++finished; });
+
+    const int lookups = 50;
+    for (int i = 0; i < lookups; ++i) {
+        validator.validateInput("localhost");
+        QTRY_COMPARE(finished, i + 1);
+    }
+
+    // The public IP is resolved every time; its record is stored after the first lookup
+    QCOMPARE(api.publicIpRequests(), lookups);
+    QCOMPARE(api.apiRequests(), 1);
+}
+
+void LookupLoadTest::testHotAddressRanking() {
+    DatabaseManager &database = DatabaseManager::instance();
+    const QStringList expected = {"192.0.2.3", "192.0.2.1", "192.0.2.2"};
+    const QList<int> lookups = {5, 3, 1};
+    for (qsizetype i = 0; i < expected.size(); ++i) {
+        for (int n = 0; n < lookups.at(i); ++n) {
+            database.recordAddressLookup(expected.at(i));
+        }
+    }
+
+    // Earlier tests add their own history, so only the relative order of these addresses is checked
+    QStringList ranked;
+    for (const QString &address : database.getHotAddresses(100)) {
+        if (expected.contains(address)) {
+            ranked.append(address);
+        }
+    }
+    QCOMPARE(ranked, expected);
+    QCOMPARE(database.getHotAddresses(1).size(), 1);
+}
+
+void LookupLoadTest::testWarmedAddressSkipsApi() {
+    const QString address = "198.51.100.42";
+    Validator validator;
+    QStringList received;
+    connect(&validator, &Validator::apiResponseReceived, this, [&received](const QString &ip) {
+        received.append(ip);
+    });
+
+    validator.validateInput(address);
+    QTRY_COMPARE(received.size(), 1);
+    QCOMPARE(api.apiRequests(), qint64(1));
+
+    CacheWarmer warmer;
+    QSignalSpy warmed(&warmer, &CacheWarmer::finished);
+    warmer.start(1000, 0);
+    QTRY_COMPARE(warmed.size(), 1);
+    QVERIFY(warmed.first().at(0).toInt() > 0);
+
+    api.resetCounters();
+    validator.validateInput(address);
+    QTRY_COMPARE(received.size(), 2);
+    QCOMPARE(received.last(), address);
+    QCOMPARE(api.apiRequests(), qint64(0));
+}
+
+LookupLoadTest::LoadReport LookupLoadTest::runLoad(int concurrency,
+                                                   const std::function<void(int, std::function<void(bool)>)> &start) {
+    const qint64 durationMs = envInt("GEOCATCH_SOAK_SECONDS", 3) * 1000;
+    const qint64 warmupMs = durationMs / 5;
+
+    LoadReport report;
+    QElapsedTimer clock;
+    clock.start();
+    int inFlight = 0;
+    bool warmedUp = false;
+
+    auto issue = std::make_shared<std::function<void(int)>>();
+    *issue = [&, issue](int slot) {
+        const qint64 startedNs = clock.nsecsElapsed();
+        ++inFlight;
+        start(slot, [&, issue, slot, startedNs](bool ok) {
+            --inFlight;
+            if (!warmedUp && clock.elapsed() >= warmupMs) {
+                warmedUp = true;
+                report.latenciesUs.clear();
+                report.completed = 0;
+                report.failed = 0;
+                report.rssAfterWarmupKb = residentSetKb();
+            }
+            report.latenciesUs.append((clock.nsecsElapsed() - startedNs) / 1000);
+            if (ok) {
+                ++report.completed;
+            } else {
+                ++report.failed;
+            }
+
+            if (clock.elapsed() < durationMs) {
+                (*issue)(slot);
+            }
+        });
+    };
+
+    for (int slot = 0; slot < concurrency; ++slot) {
+        (*issue)(slot);
+    }
+
+    QTRY_VERIFY_WITH_TIMEOUT(clock.elapsed() >= durationMs && inFlight == 0, int(durationMs) + 60000);
+    report.seconds = (clock.elapsed() - warmupMs) / 1000.0;
+    report.rssAtEndKb = residentSetKb();
+    *issue = nullptr; // Break the self-reference
+    return report;
+}
+
+void LookupLoadTest::printAndCheck(const char *name, LoadReport &report) {
+    std::sort(report.latenciesUs.begin(), report.latenciesUs.end());
+    const qint64 growthKb = report.rssAfterWarmupKb >= 0 ? report.rssAtEndKb - report.rssAfterWarmupKb : 0;
+
+    qInfo().noquote() << QString("%1: %2 lookups/s, p50 %3 ms, p99 %4 ms, %5 ok, %6 failed, RSS %7 KB -> %8 KB (%9 KB)")
+                             .arg(name)
+                             .arg((report.completed + report.failed) / qMax(report.seconds, 0.001), 0, 'f', 0)
+                             .arg(percentile(report.latenciesUs, 0.50) / 1000.0, 0, 'f', 2)
+                             .arg(percentile(report.latenciesUs, 0.99) / 1000.0, 0, 'f', 2)
+                             .arg(report.completed)
+                             .arg(report.failed)
+                             .arg(report.rssAfterWarmupKb)
+                             .arg(report.rssAtEndKb)
+                             .arg(growthKb);
+
+    QVERIFY(report.completed > 0);
+    QVERIFY2(growthKb < envInt("GEOCATCH_SOAK_MAX_GROWTH_MB", 32) * 1024, "Memory grew during the soak run");
+}
+
+void LookupLoadTest::soakNetworkManager() {
+    api.setLatency(MockGeoApi::Latency::LogNormal, 20);
+    api.setErrorRate(0.01);
+    api.setRateLimitRate(0.02);
+
+    // QNetworkAccessManager opens at most six connections per host, so load is spread over clients
+    const int concurrency = envInt("GEOCATCH_SOAK_CONCURRENCY", 2000);
+    QList<std::shared_ptr<NetworkManager>> clients;
+    for (int i = 0; i < envInt("GEOCATCH_SOAK_CLIENTS", 64); ++i) {
+        clients.append(std::make_shared<NetworkManager>());
+    }
+
+    QRandomGenerator rng(1);
+    LoadReport report = runLoad(concurrency, [&](int slot, std::function<void(bool)> done) {
+        NetworkManager *client = clients.at(slot % clients.size()).get();
+        client->fetchAddressData(randomPoolAddress(rng)).then(this, [done](const QVariantMap &data) {
+            done(!data.isEmpty());
+        });
+    });
+
+    printAndCheck("NetworkManager", report);
+    QVERIFY(report.failed > 0); // The mock injected errors
+}
+
+void LookupLoadTest::soakValidator() {
+    api.setLatency(MockGeoApi::Latency::LogNormal, 20);
+
+    // A Validator runs one lookup at a time, so concurrency comes from many instances
+    const int concurrency = envInt("GEOCATCH_SOAK_CLIENTS", 64);
+    QList<std::shared_ptr<Validator>> validators;
+    QList<std::function<void(bool)>> pending(concurrency);
+    for (int i = 0; i < concurrency; ++i) {
+        auto validator = std::make_shared<Validator>();
+        connect(validator.get(), &Validator::requestFinished, this, [&pending, i]() {
+            std::function<void(bool)> done = std::move(pending[i]);
+            pending[i] = nullptr;
+            if (done) {
+                done(true);
+            }
+        });
+        validators.append(validator);
+    }
+
+    QRandomGenerator rng(2);
+    LoadReport report = runLoad(concurrency, [&](int slot, std::function<void(bool)> done) {
+        pending[slot] = std::move(done);
+        validators.at(slot)->validateInput(randomPoolAddress(rng));
+    });
+
+    // Pool addresses are served from the store after their first lookup
+    printAndCheck("Validator", report);
+    QVERIFY(api.apiRequests() > 0);
+}
+
+QTEST_GUILESS_MAIN(LookupLoadTest)
+#include "lookupLoadTest.moc"
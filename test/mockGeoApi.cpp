@@ -0,0 +1,135 @@
+#include "mockGeoApi.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPointer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <cmath>
+#include <random>
+
+MockGeoApi::MockGeoApi(QObject *parent) : QObject(parent) {
+    connect(&server, &QTcpServer::newConnection, this, [this]() {
+        while (QTcpSocket *socket = server.nextPendingConnection()) {
+            connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { readRequests(socket); });
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        }
+    });
+}
+
+bool MockGeoApi::listen() {
+    return server.listen(QHostAddress::LocalHost, 0);
+}
+
+QUrl MockGeoApi::apiUrl() const {
+    return QUrl(QString("http://127.0.0.1:%1/").arg(server.serverPort()));
+}
+
+QUrl MockGeoApi::publicIpUrl() const {
+    return QUrl(QString("http://127.0.0.1:%1/ip").arg(server.serverPort()));
+}
+
+QUrl MockGeoApi::connectionCheckUrl() const {
+    return apiUrl();
+}
+
+void MockGeoApi::setLatency(Latency shape, int medianMs) {
+    latencyShape = shape;
+    latencyMedianMs = qMax(medianMs, 0);
+}
+
+void MockGeoApi::resetCounters() {
+    apiRequestCount.storeRelaxed(0);
+    publicIpRequestCount.storeRelaxed(0);
+    failedResponseCount.storeRelaxed(0);
+}
+
+int MockGeoApi::nextLatencyMs() {
+    switch (latencyShape) {
+    case Latency::Fixed:
+        return latencyMedianMs;
+    case Latency::Uniform:
+        return int(rng.bounded(2 * latencyMedianMs + 1));
+    case Latency::LogNormal: {
+        // sigma 0.6 puts p99 at about four times the median
+        std::lognormal_distribution<double> distribution(std::log(qMax(latencyMedianMs, 1)), 0.6);
+        return qMin(int(distribution(rng)), 30000);
+    }
+    }
+    return latencyMedianMs;
+}
+
+void MockGeoApi::readRequests(QTcpSocket *socket) {
+    // Requests have no body, so each one ends at the first blank line
+    while (true) {
+        const QByteArray buffered = socket->peek(socket->bytesAvailable());
+        const qsizetype headerEnd = buffered.indexOf("\r\n\r\n");
+        if (headerEnd < 0) {
+            return;
+        }
+
+        const QByteArray head = socket->read(headerEnd + 4);
+        const QList<QByteArray> requestLine = head.left(head.indexOf("\r\n")).split(' ');
+        if (requestLine.size() < 2) {
+            socket->disconnectFromHost();
+            return;
+        }
+        respond(socket, requestLine.at(0), requestLine.at(1));
+    }
+}
+
+void MockGeoApi::respond(QTcpSocket *socket, const QByteArray &method, const QByteArray &path) {
+    int status = 200;
+    QByteArray body;
+
+    if (method == "HEAD") {
+        // Connection check
+    } else if (path.startsWith("/ip")) {
+        publicIpRequestCount.fetchAndAddRelaxed(1);
+        body = QJsonDocument(QJsonObject{{"ip", publicIp}}).toJson(QJsonDocument::Compact);
+    } else {
+        apiRequestCount.fetchAndAddRelaxed(1);
+        const double roll = rng.generateDouble();
+        if (roll < rateLimitRate) {
+            status = 429;
+        } else if (roll < rateLimitRate + errorRate) {
+            status = 500;
+        } else {
+            // /<ip>/json?token=...
+            const QString ip = QString::fromLatin1(path.mid(1, path.indexOf('/', 1) - 1));
+            const QStringList octets = ip.split('.');
+            const int bucket = octets.isEmpty() ? 0 : octets.first().toInt() % 8;
+            body = QJsonDocument(QJsonObject{
+                {"ip", ip},
+                {"hostname", "host-" + QString(ip).replace('.', '-') + ".example.net"},
+                {"city", QString("City %1").arg(bucket)},
+                {"region", QString("Region %1").arg(bucket % 4)},
+                {"country", QString("C%1").arg(bucket % 2)},
+                {"loc", "52.5200,13.4050"},
+                {"postal", QString("%1").arg(10000 + bucket)},
+                {"timezone", "Europe/Berlin"}
+            }).toJson(QJsonDocument::Compact);
+        }
+        if (status != 200) {
+            failedResponseCount.fetchAndAddRelaxed(1);
+        }
+    }
+
+    const QByteArray reason = status == 200 ? "OK" : status == 429 ? "Too Many Requests" : "Internal Server Error";
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + ' ' + reason + "\r\n"
+                          "Content-Type: application/json\r\n"
+                          "Content-Length: " + QByteArray::number(method == "HEAD" ? 0 : body.size()) + "\r\n"
+                          "Connection: keep-alive\r\n\r\n";
+    if (method != "HEAD") {
+        response += body;
+    }
+
+    // Responses on one connection keep their order because QNetworkAccessManager does not
+    // pipeline, so the next request only arrives after this one is answered
+    QTimer::singleShot(nextLatencyMs(), socket, [socket = QPointer<QTcpSocket>(socket), response]() {
+        if (socket) {
+            socket->write(response);
+        }
+    });
+}
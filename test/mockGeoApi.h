@@ -0,0 +1,92 @@
+#ifndef MOCKGEOAPI_H
+#define MOCKGEOAPI_H
+
+#include <QAtomicInteger>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QTcpServer>
+#include <QUrl>
+
+class QTcpSocket;
+
+/**
+ * @class MockGeoApi
+ * @brief In-process HTTP server that emulates the ipinfo and ipify APIs for tests.
+ *
+ * GET /<ip>/json answers with an ipinfo-style object derived from the address, GET /ip
+ * answers with {"ip": ...} and HEAD / with an empty 200, so a NetworkManager can be pointed
+ * at it through NetworkManager::Endpoints. Each response is delayed by a latency drawn from
+ * the configured distribution, and a configurable fraction fails with 500 or 429.
+ */
+class MockGeoApi : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Shape of the response latency distribution.
+     */
+    enum class Latency {
+        Fixed,    ///< Always the median.
+        Uniform,  ///< Uniform between 0 and twice the median.
+        LogNormal ///< Log-normal around the median, with a long tail like real APIs.
+    };
+
+    explicit MockGeoApi(QObject *parent = nullptr);
+
+    /**
+     * @brief Start listening on a free local port.
+     * @return True if the server is listening.
+     */
+    bool listen();
+
+    /**
+     * @brief Endpoints that point a NetworkManager at this server.
+     */
+    QUrl apiUrl() const;
+    QUrl publicIpUrl() const;
+    QUrl connectionCheckUrl() const;
+
+    /**
+     * @brief Set the response latency.
+     * @param shape Shape of the distribution.
+     * @param medianMs Median latency in milliseconds.
+     */
+    void setLatency(Latency shape, int medianMs);
+
+    /**
+     * @brief Set the fraction of API requests answered with 500 Internal Server Error.
+     */
+    void setErrorRate(double rate) { errorRate = rate; }
+
+    /**
+     * @brief Set the fraction of API requests answered with 429 Too Many Requests.
+     */
+    void setRateLimitRate(double rate) { rateLimitRate = rate; }
+
+    /**
+     * @brief Address returned by the public IP endpoint.
+     */
+    static constexpr const char *publicIp = "203.0.113.7";
+
+    qint64 apiRequests() const { return apiRequestCount.loadRelaxed(); }
+    qint64 publicIpRequests() const { return publicIpRequestCount.loadRelaxed(); }
+    qint64 failedResponses() const { return failedResponseCount.loadRelaxed(); }
+    void resetCounters();
+
+private:
+    void readRequests(QTcpSocket *socket);
+    void respond(QTcpSocket *socket, const QByteArray &method, const QByteArray &path);
+    int nextLatencyMs();
+
+    QTcpServer server;
+    QRandomGenerator rng{20241018};
+    Latency latencyShape = Latency::Fixed;
+    int latencyMedianMs = 0;
+    double errorRate = 0;
+    double rateLimitRate = 0;
+    QAtomicInteger<qint64> apiRequestCount = 0;
+    QAtomicInteger<qint64> publicIpRequestCount = 0;
+    QAtomicInteger<qint64> failedResponseCount = 0;
+};
+
+#endif // MOCKGEOAPI_H